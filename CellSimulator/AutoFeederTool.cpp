@@ -1,6 +1,7 @@
 #include "AutoFeederTool.h"
 #include "Environment.h"
 #include "FoodManager.h"
+#include "SimulationClock.h"
 #include <iostream>
 
 std::mutex AutoFeederTool::mutex;
@@ -14,7 +15,7 @@ AutoFeederTool::AutoFeederTool() {
 	maxFoodPerSec = 5;
 	spawnTime = 1000 / maxFoodPerSec;
 	isActive = false;
-	clock.restart();
+	lastSpawnTime = SimulationClock::getInstance().getElapsedTime();
 }
 
 AutoFeederTool & AutoFeederTool::getInstance()
@@ -31,8 +32,9 @@ void AutoFeederTool::configure(int maxThresholdValue)
 
 void AutoFeederTool::update()
 {
-	auto& foodVector = Environment::getInstance().getFoodsVector();
-	int deltaTime = clock.getElapsedTime().asMilliseconds();
+	auto& foodStore = Environment::getInstance().getFoodStore();
+	auto now = SimulationClock::getInstance().getElapsedTime();
+	int deltaTime = (now - lastSpawnTime).asMilliseconds();
 	auto env = Environment::getInstance().getSize();
 	//Logger::log(env);
 	auto area = env.x*env.y;
@@ -40,12 +42,12 @@ void AutoFeederTool::update()
 
 	auto p = 0.000001*2 * maxThresholdValue * area;
 	//Logger::log(p);
-	if (foodVector.size() < p && deltaTime > spawnTime && isActive) {
+	if (foodStore.size() < p && deltaTime > spawnTime && isActive) {
 		FoodManager::getInstance().generateFood(sf::Vector2f(3,12), deltaTime/spawnTime);
-		clock.restart();
+		lastSpawnTime = now;
 	}
 	else if (deltaTime > spawnTime) {
-		clock.restart();
+		lastSpawnTime = now;
 	}
 }
 
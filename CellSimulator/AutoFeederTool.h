@@ -24,9 +24,9 @@ private:
 	AutoFeederTool(AutoFeederTool const&) = delete;
 	AutoFeederTool& operator=(AutoFeederTool const&) = delete;
 
-	sf::Clock clock;
+	// simulated time of last spawn
+	sf::Time lastSpawnTime;
 	int spawnTime;
-	sf::Time deltaTime;
 	static std::mutex mutex;
 	std::atomic<int> maxThresholdValue;
 	std::atomic<int> maxFoodPerSec;
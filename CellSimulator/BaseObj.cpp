@@ -108,6 +108,11 @@ bool BaseObj::isMarkedToDelete()
 }
 
 std::pair<bool, double> BaseObj::collision(std::shared_ptr<BaseObj> obj)
+{
+	return collision(obj.get());
+}
+
+std::pair<bool, double> BaseObj::collision(BaseObj* obj)
 {
 	auto sizes = this->getSize() + obj->getSize();
 	auto subPosition = this->getPosition() - obj->getPosition();
@@ -126,5 +131,5 @@ void BaseObj::setSelfPtr(std::shared_ptr<BaseObj> s)
 
 std::shared_ptr<BaseObj> BaseObj::getSelfPtr()
 {
-	return self;
+	return self.lock();
 }
@@ -15,13 +15,13 @@ public:
 	virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 	virtual void update() = 0;
 
-	float getSize();
+	virtual float getSize();
 	virtual void setSize(const float&);
 
-	float getRotation();
+	virtual float getRotation();
 	virtual void setRotation(const float&);
 
-	sf::Vector2f getPosition();
+	virtual sf::Vector2f getPosition();
 	virtual void setPosition(const sf::Vector2f&);
 
 	sf::Color getBaseColor();
@@ -42,12 +42,14 @@ public:
 	bool isMarkedToDelete();
 
 	std::pair<bool,double> collision(std::shared_ptr<BaseObj> obj);
+	std::pair<bool,double> collision(BaseObj* obj);
 
 	void setSelfPtr(std::shared_ptr<BaseObj> s);
 	std::shared_ptr<BaseObj> getSelfPtr();
 
 protected:
-	sf::CircleShape shape;
+	// derived objects can keep their state elsewhere and update shape lazily in draw
+	mutable sf::CircleShape shape;
 
 	struct VarAbbrv final
 	{
@@ -68,7 +70,8 @@ protected:
 
 private:
 	bool toDelete;
-	std::shared_ptr<BaseObj> self;
+	// weak - strong self pointer would keep object alive forever
+	std::weak_ptr<BaseObj> self;
 	sf::Color baseColor;
 };
 
@@ -1,25 +1,20 @@
 #include "Cell.h"
 #include "Food.h"
 #include "CellRoles.h"
-#include "CellSimApp.h"
 #include "Environment.h"
 #include "BaseObj.h"
 #include "RegexPattern.h"
 #include "TextureProvider.h"
-#include "MessagesManager.h"
 #include <sstream>
 #include <regex>
+#include <cmath>
 
 Cell::Cell() : BaseObj(), horniness(0, 100, 0)
 {
-	age = 0;
-	foodLevel = 0;
-	currentSpeed = 0;
-
 	shape.setOutlineThickness(-5);
 	shape.setOutlineColor(sf::Color(128, 64, 0, 75));
 
-	delayTime = CellSimApp::getInstance().getDeltaTime();
+	delayTime = Environment::getInstance().getDeltaTime();
 
 	setSize(20);
 	setPosition({ 0,0 });
@@ -28,11 +23,11 @@ Cell::Cell() : BaseObj(), horniness(0, 100, 0)
 
 Cell::Cell(float size, sf::Vector2f position, sf::Color color) : BaseObj(size, position, color), horniness(0, 100, 0)
 {
-	this->age = 0;
+	this->setAge(0);
 
-	this->foodLevel = this->genes.foodLimit.get() / 2;
+	this->setFoodLevel(this->getGenes().foodLimit.get() / 2);
 
-	this->currentSpeed = randomReal(0.1, genes.maxSpeed.get());
+	this->setCurrentSpeed(randomReal(0.1, getGenes().maxSpeed.get()));
 
 	this->horniness.randomize();
 
@@ -40,13 +35,14 @@ Cell::Cell(float size, sf::Vector2f position, sf::Color color) : BaseObj(size, p
 
 	setSize(size);
 	setPosition(position);
+	// BaseObj constructor draws random rotation - copy it to store
+	setRotation(BaseObj::getRotation());
 	typeShape.setPointCount(3);
 
 	int textureSize = randomInt(6, 12);
 	float rnd = randomInt(0, 32); //64 - texture size
-	TextureProvider::getInstance().getTexture("whiteNoise")->setRepeated(true);
 	shape.setTextureRect(sf::IntRect(sf::Vector2i(rnd, rnd), sf::Vector2i(textureSize, textureSize)));
-	shape.setTexture(TextureProvider::getInstance().getTexture("whiteNoise").get());
+	setTexture("whiteNoise");
 
 	shape.setOutlineThickness(-5);
 	shape.setOutlineColor(sf::Color(128, 64, 0, 75));
@@ -77,23 +73,23 @@ Cell::Cell(float size, sf::Vector2f position, sf::Color color) : BaseObj(size, p
 	// cell should be moved after all updates
 	roles.push_back(CellRoles::moveForward);
 
-	delayTime = CellSimApp::getInstance().getDeltaTime();
+	delayTime = Environment::getInstance().getDeltaTime();
 }
 
-Cell::Cell(Cell a, Cell b) : Cell(20, (a.getPosition() + b.getPosition()) / 2.0f, a.getBaseColor()*b.getBaseColor())
+Cell::Cell(Cell& a, Cell& b) : Cell(20, (a.getPosition() + b.getPosition()) / 2.0f, a.getBaseColor()*b.getBaseColor())
 {
 	double mutationRatio = Environment::getInstance().getRadiation();
 
-	genes.aggresion = mutationRatio <= randomReal(0, 100) ? MixDouble(a.genes.aggresion.get(), b.genes.divisionThreshold.get()) : (a.genes.aggresion.get() + b.genes.divisionThreshold.get()) / 2;
-	genes.divisionThreshold = mutationRatio <= randomReal(0, 100) ? MixDouble(a.genes.divisionThreshold.get(), b.genes.divisionThreshold.get()) : (a.genes.divisionThreshold.get() + b.genes.divisionThreshold.get()) / 2;
-	genes.foodLimit = mutationRatio <= randomReal(0, 100) ? MixDouble(a.genes.foodLimit.get(), b.genes.foodLimit.get()) : (a.genes.foodLimit.get() + b.genes.foodLimit.get()) / 2;
-	genes.maxAge = mutationRatio <= randomReal(0, 100) ? MixDouble(a.genes.maxAge.get(), b.genes.maxAge.get()) : (a.genes.maxAge.get() + b.genes.maxAge.get()) / 2;
-	genes.maxSize = mutationRatio <= randomReal(0, 100) ? MixDouble(a.genes.maxSize.get(), b.genes.maxSize.get()) : (a.genes.maxSize.get() + b.genes.maxSize.get()) / 2;
-	genes.maxSpeed = mutationRatio <= randomReal(0, 100) ? MixDouble(a.genes.maxSpeed.get(), b.genes.maxSpeed.get()) : (a.genes.maxSpeed.get() + b.genes.maxSpeed.get()) / 2;
-	genes.radarRange = mutationRatio <= randomReal(0, 100) ? MixDouble(a.genes.radarRange.get(), b.genes.radarRange.get()) : (a.genes.radarRange.get() + b.genes.radarRange.get()) / 2;
+	getGenes().aggresion = mutationRatio <= randomReal(0, 100) ? MixDouble(a.getGenes().aggresion.get(), b.getGenes().divisionThreshold.get()) : (a.getGenes().aggresion.get() + b.getGenes().divisionThreshold.get()) / 2;
+	getGenes().divisionThreshold = mutationRatio <= randomReal(0, 100) ? MixDouble(a.getGenes().divisionThreshold.get(), b.getGenes().divisionThreshold.get()) : (a.getGenes().divisionThreshold.get() + b.getGenes().divisionThreshold.get()) / 2;
+	getGenes().foodLimit = mutationRatio <= randomReal(0, 100) ? MixDouble(a.getGenes().foodLimit.get(), b.getGenes().foodLimit.get()) : (a.getGenes().foodLimit.get() + b.getGenes().foodLimit.get()) / 2;
+	getGenes().maxAge = mutationRatio <= randomReal(0, 100) ? MixDouble(a.getGenes().maxAge.get(), b.getGenes().maxAge.get()) : (a.getGenes().maxAge.get() + b.getGenes().maxAge.get()) / 2;
+	getGenes().maxSize = mutationRatio <= randomReal(0, 100) ? MixDouble(a.getGenes().maxSize.get(), b.getGenes().maxSize.get()) : (a.getGenes().maxSize.get() + b.getGenes().maxSize.get()) / 2;
+	getGenes().maxSpeed = mutationRatio <= randomReal(0, 100) ? MixDouble(a.getGenes().maxSpeed.get(), b.getGenes().maxSpeed.get()) : (a.getGenes().maxSpeed.get() + b.getGenes().maxSpeed.get()) / 2;
+	getGenes().radarRange = mutationRatio <= randomReal(0, 100) ? MixDouble(a.getGenes().radarRange.get(), b.getGenes().radarRange.get()) : (a.getGenes().radarRange.get() + b.getGenes().radarRange.get()) / 2;
 
 
-	delayTime = CellSimApp::getInstance().getDeltaTime();
+	delayTime = Environment::getInstance().getDeltaTime();
 }
 
 Cell::Cell(std::string formattedCellString) : Cell(20, { 0,0 }, sf::Color::White)
@@ -150,9 +146,9 @@ Cell::Cell(std::string formattedCellString) : Cell(20, { 0,0 }, sf::Color::White
 				modifyValueFromString(type_i->str(), name_i->str());
 		}
 	}
-	if (genes.type.get() != -1)
+	if (getGenes().type.get() != -1)
 	{
-		CellRoles::updateColor(this);
+		CellRoles::refreshColors(this);
 	}
 	else
 	{
@@ -160,7 +156,7 @@ Cell::Cell(std::string formattedCellString) : Cell(20, { 0,0 }, sf::Color::White
 		typeShape.setOutlineColor(sf::Color::Transparent);
 	}
 
-	delayTime = CellSimApp::getInstance().getDeltaTime();
+	delayTime = Environment::getInstance().getDeltaTime();
 }
 
 void Cell::modifyValueFromString(std::string valueName, std::string value)
@@ -170,25 +166,25 @@ void Cell::modifyValueFromString(std::string valueName, std::string value)
 
 	if (v == VarAbbrv::currentRotation)			this->setRotation(std::stod(value));
 	else if (v == VarAbbrv::currentAge)			this->setAge(std::stod(value));
-	else if (v == VarAbbrv::currentSpeed)		this->currentSpeed = (std::stod(value));
+	else if (v == VarAbbrv::currentSpeed)		this->setCurrentSpeed(std::stod(value));
 	else if (v == VarAbbrv::currentSize)		this->setSize((std::stod(value)));
 	else if (v == VarAbbrv::isDead)				this->dead = (std::stod(value));
 	else if (v == VarAbbrv::name)				this->name = (value);
 
-	else if (v == VarAbbrv::currentFoodLevel)	this->foodLevel = (std::stod(value));
+	else if (v == VarAbbrv::currentFoodLevel)	this->setFoodLevel(std::stod(value));
 	else if (v == VarAbbrv::isFreezed)			this->freezed = (std::stod(value));
 	else if (v == VarAbbrv::horniness)			this->horniness = (std::stod(value));
-	else if (v == VarAbbrv::aggression)			this->genes.aggresion = (std::stod(value));
-	else if (v == VarAbbrv::divisionTh)			this->genes.divisionThreshold = (std::stod(value));
-	else if (v == VarAbbrv::foodLimit)			this->genes.foodLimit = (std::stod(value));
-	else if (v == VarAbbrv::maxAge)				this->genes.maxAge = (std::stod(value));
-	else if (v == VarAbbrv::maxSize)			this->genes.maxSize = (std::stod(value));
-	else if (v == VarAbbrv::maxSpeed)			this->genes.maxSpeed = (std::stod(value));
-	else if (v == VarAbbrv::radarRange)			this->genes.radarRange = (std::stod(value));
-	else if (v == VarAbbrv::metabolism)			this->genes.metabolism = (std::stod(value));
-	else if (v == VarAbbrv::type)				this->genes.type = (std::stod(value));
-	else if (v == VarAbbrv::turningRate)		this->genes.turningRate = (std::stod(value));
-	else if (v == BaseObj::VarAbbrv::texture)	this->shape.setTexture(TextureProvider::getInstance().getTexture(value).get());
+	else if (v == VarAbbrv::aggression)			this->getGenes().aggresion = (std::stod(value));
+	else if (v == VarAbbrv::divisionTh)			this->getGenes().divisionThreshold = (std::stod(value));
+	else if (v == VarAbbrv::foodLimit)			this->getGenes().foodLimit = (std::stod(value));
+	else if (v == VarAbbrv::maxAge)				this->getGenes().maxAge = (std::stod(value));
+	else if (v == VarAbbrv::maxSize)			this->getGenes().maxSize = (std::stod(value));
+	else if (v == VarAbbrv::maxSpeed)			this->getGenes().maxSpeed = (std::stod(value));
+	else if (v == VarAbbrv::radarRange)			this->getGenes().radarRange = (std::stod(value));
+	else if (v == VarAbbrv::metabolism)			this->getGenes().metabolism = (std::stod(value));
+	else if (v == VarAbbrv::type)				this->getGenes().type = (std::stod(value));
+	else if (v == VarAbbrv::turningRate)		this->getGenes().turningRate = (std::stod(value));
+	else if (v == BaseObj::VarAbbrv::texture)	this->setTexture(value);
 	else if (v == BaseObj::VarAbbrv::markedToDelete)
 	{
 		if (std::stod(value)) this->markToDelete();
@@ -239,7 +235,7 @@ void Cell::modifyValueFromVector(std::string valueName, const std::vector<std::s
 	}
 	else if (v == VarAbbrv::cellRoles)
 	{
-		roles.clear();
+		dropRoles();
 		for (int i = 0; i < values.size(); ++i)
 		{
 			this->addRole(CellRoles::getManager().getRoleById(std::stod(values.at(i))));
@@ -253,13 +249,58 @@ Cell::~Cell()
 
 void Cell::update()
 {
+	auto& context = Environment::getInstance().getTickContext();
+	sense(context);
+	act(context);
+}
+
+void Cell::sense(const TickContext& context)
+{
+	RandomStreamScope randomScope(randomStream);
+
 	if (!freezed)
 		for (auto& fn : roles)
 		{
-			fn(this);
+			if (CellRoles::isSenseRole(fn))
+				fn(this, context);
 		}
 }
 
+void Cell::act(const TickContext& context)
+{
+	RandomStreamScope randomScope(randomStream);
+
+	if (!freezed)
+		for (auto& fn : roles)
+		{
+			if (!CellRoles::isSenseRole(fn))
+				fn(this, context);
+		}
+}
+
+int Cell::getArchetype()
+{
+	if (archetype < 0)
+		archetype = CellRoles::getManager().getArchetypeId(roles);
+	return archetype;
+}
+
+bool Cell::hasArchetype(int archetype)
+{
+	return this->archetype == archetype;
+}
+
+void Cell::runRole(void(*role)(Cell *, const TickContext&), const TickContext& context)
+{
+	RandomStreamScope randomScope(randomStream);
+	role(this, context);
+}
+
+void Cell::seedRandomStream(uint64_t seed, uint64_t streamId)
+{
+	randomStream.seed(seed, streamId);
+}
+
 void Cell::freeze()
 {
 	freezed = true;
@@ -278,15 +319,25 @@ void Cell::unfreeze()
 	freezed = false;
 }
 
+bool Cell::isFreezed()
+{
+	return freezed;
+}
+
+CellNeighbours & Cell::getNeighbours()
+{
+	return neighbours;
+}
+
 void Cell::kill()
 {
 	if (!dead)
 	{
-		if (!name.empty()) MessagesManager::getInstance().append(name + " died [*].");
-
 		dead = true;
+		Environment::getInstance().registerKilledCell(this);
 		roles.clear();
 		roles.push_back(CellRoles::beDead);
+		archetype = -1;
 
 		auto color = randomInt(0, 32);
 		auto color2 = randomInt(0, 32);
@@ -307,17 +358,8 @@ void Cell::kill()
 
 			auto position = getPosition() + sf::Vector2f{ xDeviation, yDeviation };
 
-			auto food = Food::create(foodSize, position, sf::Color::Black, foodSize);
-			Environment::getInstance().insertNewFood(food);
+			Environment::getInstance().insertNewFood(Food(foodSize, position, sf::Color::Black, foodSize));
 		}
-
-		// update collision sectors
-		const auto currentCollisionSectorCoords = Environment::getCollisionSectorCoords(getSelfPtr());
-
-		auto& sectors = Environment::getInstance().getCellCollisionSectors();
-		auto& cellCollisionSector = sectors[currentCollisionSectorCoords.x][currentCollisionSectorCoords.y];
-
-		cellCollisionSector.erase(std::remove(cellCollisionSector.begin(), cellCollisionSector.end(), getSelfPtr()), cellCollisionSector.end());
 	}
 }
 
@@ -326,41 +368,6 @@ bool Cell::isDead()
 	return this->dead;
 }
 
-Genes& Cell::getGenes()
-{
-	return this->genes;
-}
-
-void Cell::setGenes(Genes g)
-{
-	genes = g;
-}
-
-double Cell::getFoodLevel()
-{
-	return this->foodLevel;
-}
-
-double Cell::getCurrentSpeed()
-{
-	return this->currentSpeed;
-}
-
-void Cell::setCurrentSpeed(double speed)
-{
-	this->currentSpeed = speed;
-}
-
-void Cell::setFoodLevel(double foodLevel)
-{
-	this->foodLevel = foodLevel;
-}
-
-void Cell::setAge(double age)
-{
-	this->age = age;
-}
-
 void Cell::setHorniness(double horniness)
 {
 	this->horniness = horniness;
@@ -369,21 +376,26 @@ DynamicRanged<double>& Cell::getHorniness()
 {
 	return this->horniness;
 }
-void Cell::dropRole(void(*role)(Cell *))
+void Cell::dropRole(void(*role)(Cell *, const TickContext&))
 {
 	auto newRolesEnd = std::remove_if(roles.begin(), roles.end(), [role](auto r) {return r == role; });
 	roles.erase(newRolesEnd, roles.end());
+	archetype = -1;
 }
 
 void Cell::dropRoles()
 {
 	roles.clear();
+	archetype = -1;
 }
 
-void Cell::addRole(void(*role)(Cell *))
+void Cell::addRole(void(*role)(Cell *, const TickContext&))
 {
 	if (std::find(roles.begin(), roles.end(), role) == roles.end())
+	{
 		roles.push_back(role);
+		archetype = -1;
+	}
 }
 
 std::string Cell::getSaveString()
@@ -393,8 +405,8 @@ std::string Cell::getSaveString()
 	result << getCellBlueprintString() <<
 		VarAbbrv::currentRotation << ":" << this->getRotation() << " " <<
 		VarAbbrv::currentPosition << ":{" << this->getPosition().x << ", " << this->getPosition().y << "} " <<
-		VarAbbrv::currentAge << ":" << this->age << " " <<
-		VarAbbrv::currentSpeed << ":" << this->currentSpeed << " " <<
+		VarAbbrv::currentAge << ":" << this->getAge() << " " <<
+		VarAbbrv::currentSpeed << ":" << this->getCurrentSpeed() << " " <<
 		VarAbbrv::currentSize << ":" << this->getSize() << " " <<
 		VarAbbrv::isDead << ":" << this->dead << " ";
 
@@ -404,7 +416,7 @@ std::string Cell::getSaveString()
 	}
 
 	result <<
-		VarAbbrv::currentFoodLevel << ":" << this->foodLevel << " " <<
+		VarAbbrv::currentFoodLevel << ":" << this->getFoodLevel() << " " <<
 		VarAbbrv::isFreezed << ":" << this->freezed << " " <<
 		VarAbbrv::horniness << ":" << this->horniness << " " <<
 		BaseObj::VarAbbrv::markedToDelete << ":" << this->isMarkedToDelete() << " " <<
@@ -422,7 +434,7 @@ std::string Cell::getSaveString()
 		this->shape.getTextureRect().top << ", " <<
 		this->shape.getTextureRect().width << ", " <<
 		this->shape.getTextureRect().height << "} " <<
-		BaseObj::VarAbbrv::texture << ":" << TextureProvider::getInstance().getTextureName(this->shape.getTexture()) << " " <<
+		BaseObj::VarAbbrv::texture << ":" << TextureProvider::getInstance().getTextureName(this->textureId) << " " <<
 		VarAbbrv::cellRoles << ":{";
 
 	if (roles.size() == 0)
@@ -443,16 +455,16 @@ std::string Cell::getCellBlueprintString()
 	std::ostringstream result;
 
 	result << "CELL-> " <<
-		VarAbbrv::aggression << ":" << genes.aggresion << " " <<
-		VarAbbrv::divisionTh << ":" << genes.divisionThreshold << " " <<
-		VarAbbrv::foodLimit << ":" << genes.foodLimit << " " <<
-		VarAbbrv::maxAge << ":" << genes.maxAge << " " <<
-		VarAbbrv::maxSize << ":" << genes.maxSize << " " <<
-		VarAbbrv::maxSpeed << ":" << genes.maxSpeed << " " <<
-		VarAbbrv::radarRange << ":" << genes.radarRange << " " <<
-		VarAbbrv::metabolism << ":" << genes.metabolism << " " <<
-		VarAbbrv::type << ":" << genes.type << " " <<
-		VarAbbrv::turningRate << ":" << genes.turningRate << " ";
+		VarAbbrv::aggression << ":" << getGenes().aggresion << " " <<
+		VarAbbrv::divisionTh << ":" << getGenes().divisionThreshold << " " <<
+		VarAbbrv::foodLimit << ":" << getGenes().foodLimit << " " <<
+		VarAbbrv::maxAge << ":" << getGenes().maxAge << " " <<
+		VarAbbrv::maxSize << ":" << getGenes().maxSize << " " <<
+		VarAbbrv::maxSpeed << ":" << getGenes().maxSpeed << " " <<
+		VarAbbrv::radarRange << ":" << getGenes().radarRange << " " <<
+		VarAbbrv::metabolism << ":" << getGenes().metabolism << " " <<
+		VarAbbrv::type << ":" << getGenes().type << " " <<
+		VarAbbrv::turningRate << ":" << getGenes().turningRate << " ";
 	return result.str();
 }
 
@@ -478,143 +490,284 @@ sf::Color Cell::getMakedFoodColor()
 
 void Cell::draw(sf::RenderTarget & target, sf::RenderStates states) const
 {
+	updateShapes();
 	BaseObj::draw(target, states);
 	target.draw(typeShape, states);
 }
 
+void Cell::applyEnvironmentTint(const sf::Color & tint)
+{
+	// dead cells fade their own colours - see CellRoles::beDead
+	if (dead) return;
+
+	// sf::Color addition saturates at 255, alpha of tint is 0
+	auto color = getBaseColor() + tint;
+	if (freezed) color.a = 128;
+
+	// only vertex colours are updated - points of shape are not rebuilt
+	if (shape.getFillColor() != color)
+		shape.setFillColor(color);
+}
+
+void Cell::invalidateColors()
+{
+	colorsOutdated = true;
+}
+
+void Cell::updateShapes() const
+{
+	if (!shapesOutdated) return;
+	shapesOutdated = false;
+
+	auto& store = CellStore::getInstance();
+	sf::Vector2f position{ store.positionX[row.get()], store.positionY[row.get()] };
+	auto size = store.radius[row.get()];
+	auto rotation = store.rotation[row.get()];
+
+	// setRadius rebuilds all points of shape - skipped when size did not change
+	if (shape.getRadius() != size)
+	{
+		shape.setRadius(size);
+		shape.setOrigin(size, size);
+		if (outlineThicknessPerSize != 0)
+			shape.setOutlineThickness(size * outlineThicknessPerSize);
+		typeShape.setRadius(size / 2);
+		typeShape.setOrigin(size / 2, size / 2);
+	}
+	shape.setPosition(position);
+	typeShape.setPosition(position);
+	shape.setRotation(rotation);
+	typeShape.setRotation(rotation);
+	// texture is loaded when cell is drawn for the first time
+	shape.setTexture(TextureProvider::getInstance().getTexture(textureId));
+}
+
+void Cell::setTexture(const std::string & name)
+{
+	textureId = TextureProvider::getInstance().getTextureId(name);
+	shapesOutdated = true;
+}
+
 void Cell::setPosition(const sf::Vector2f & v)
 {
-	BaseObj::setPosition(v);
-	typeShape.setPosition(v);
+	auto& store = CellStore::getInstance();
+	store.positionX[row.get()] = v.x;
+	store.positionY[row.get()] = v.y;
+	shapesOutdated = true;
 }
 
 void Cell::setSize(const float & s)
 {
-	BaseObj::setSize(s);
-	typeShape.setRadius(s / 2);
-	typeShape.setOrigin(s / 2, s / 2);
+	CellStore::getInstance().radius[row.get()] = s;
+	shapesOutdated = true;
 }
 
 void Cell::setRotation(const float & f)
 {
-	BaseObj::setRotation(f);
-	typeShape.setRotation(f);
+	// <0, 360) range - the same as sf::Transformable
+	auto rotation = static_cast<float>(std::fmod(f, 360));
+	if (rotation < 0) rotation += 360.f;
+
+	// heading is recomputed only when cell turns
+	constexpr double degreesToRadians = 3.14159265358979323846 / 180;
+	auto& store = CellStore::getInstance();
+	store.rotation[row.get()] = rotation;
+	store.headingX[row.get()] = std::sin(degreesToRadians * rotation);
+	store.headingY[row.get()] = -std::cos(degreesToRadians * rotation);
+	shapesOutdated = true;
 }
 
 void Cell::rotate(const float & r)
 {
-	shape.rotate(r);
-	typeShape.setRotation(shape.getRotation());
+	setRotation(getRotation() + r);
 }
 
 sf::CircleShape & Cell::getTypeShape()
 {
+	updateShapes();
 	return typeShape;
 }
 
  std::shared_ptr<BaseObj> Cell::getClosestCell()
 {
-	 return closestCell.first;
+	 auto cell = CellPool::getInstance().get(closestCell.first);
+	 return cell != nullptr ? cell->getSelfPtr() : nullptr;
 }
 
- std::shared_ptr<BaseObj> Cell::getClosestFood()
+CellHandle Cell::getHandle()
+{
+	return registration.get();
+}
+
+ Food* Cell::getClosestFood()
  {
-	 return closestFood.first;
+	 return Environment::getInstance().getFoodStore().get(closestFood.first);
  }
 
-void Cell::calcFoodCollisionVector()
+void Cell::calcCollisionVectors()
 {
-	this->FoodCollisionVector->clear();
-	auto& foodSectors = Environment::getInstance().getFoodCollisionSectors();
-	const auto sectorsX = foodSectors.size();
-	const auto sectorsY = foodSectors[0].size();
+	auto& environment = Environment::getInstance();
+	auto& foods = environment.getFoodStore();
+	auto& cells = environment.getCellsVector();
+	auto& foodSectors = environment.getFoodCollisionSectors();
+	auto& cellSectors = environment.getCellCollisionSectors();
+	auto& neighbourLists = environment.getNeighbourLists();
+
+	const auto position = getPosition();
+	const auto size = getSize();
+	const auto radarRange = getGenes().radarRange.get();
+
+	// between searches only contacts are collected - tracked targets are checked by handles
+	const bool searchTargets = --targetSearchCountdown <= 0 || !updateTrackedTargets();
+	if (searchTargets)
+	{
+		targetSearchCountdown = environment.getTargetSearchInterval();
+		closestFood = std::make_pair(FoodHandle(), -1.0);
+		closestCell = std::make_pair(CellHandle(), -1.0);
+	}
+	const size_t targetsCount = searchTargets ? 1 : 0;
 
-	auto cellPtr = this->getSelfPtr();
-	auto cellPosition = Environment::getCollisionSectorCoords(cellPtr);
+	// neighbour lists are built in rebuild step only - cells added later (or skipped) take contacts from query
+	const bool buildList = neighbourLists.isRebuildStep();
+	if (buildList) neighbours.listGeneration = neighbourLists.getGeneration();
+	const bool useList = neighbours.listGeneration == neighbourLists.getGeneration() && neighbours.owner == getHandle();
+	const bool queryContacts = buildList || !useList;
+	const float contactMargin = buildList ? neighbourLists.getSkin() : 0;
 
-	auto minX = cellPosition.x - static_cast<int>(this->genes.radarRange.get() / 50 + 0.5);
-	if (minX < 0) minX = 0;
+	if (searchTargets || queryContacts)
+	{
+		const double foodContactRange = size + foodSectors.getMaxRadius() + contactMargin;
+		const double cellContactRange = queryContacts ? size + cellSectors.getMaxRadius() + contactMargin : 0;
+
+		// level of grids matching the farthest object this query can look for
+		auto queryRange = std::max(searchTargets ? static_cast<double>(radarRange) : 0.0,
+			queryContacts ? std::max(foodContactRange, cellContactRange) : 0.0);
+		auto level = foodSectors.selectLevel(position, queryRange, cellSectors);
+
+		// closest food in radar range and all eaten food - food can touch cell only closer than size + largest food
+		// food does not move - packed positions of food sectors are scanned with vector instructions
+		PackedNearestSearch foodSearch(position, radarRange, searchTargets, size, contactMargin,
+			foodContactRange, queryContacts, nearbyFood);
+
+		auto cellSearch = makeNearestSearch(radarRange, cellContactRange, targetsCount,
+			[&](uint32_t index) {
+				auto& cell = cells[index];
+				if (cell.get() == this || cell->isMarkedToDelete()) return -1.0;
+				auto subPosition = environment.getDisplacement(cell->getPosition(), position);
+				return static_cast<double>(subPosition.x*subPosition.x + subPosition.y*subPosition.y);
+			},
+			[&](uint32_t index, double distance) {
+				auto sizes = size + cells[index]->getSize() + contactMargin;
+				return distance <= sizes * sizes;
+			},
+			nearbyCells);
+
+		// one walk over sectors for both grids - in toroidal world also around copies of position across borders
+		auto& foodGrid = foodSectors.getLevel(level);
+		auto& cellGrid = cellSectors.getLevel(level);
+		environment.forEachWrappedImage(position, queryRange, [&](const sf::Vector2f& image) {
+			foodSearch.setPosition(image);
+			foodGrid.findNearest(image, foodSearch, cellGrid, cellSearch);
+		});
+	}
 
-	auto minY = cellPosition.y - static_cast<int>(this->genes.radarRange.get() / 50 + 0.5);
-	if (minY < 0) minY = 0;
+	if (searchTargets && !nearbyFood.nearest.empty())
+	{
+		this->closestFood.first = foods.getHandle(nearbyFood.nearest.front().first);
+		this->closestFood.second = nearbyFood.nearest.front().second;
+	}
 
-	auto maxX = cellPosition.x + static_cast<int>(this->genes.radarRange.get() / 50 + 0.5);
-	if (maxX >= sectorsX) maxX = sectorsX - 1;
+	if (searchTargets && !nearbyCells.nearest.empty())
+	{
+		auto& cell = cells[nearbyCells.nearest.front().first];
+		this->closestCell.first = cell->getHandle();
+		this->closestCell.second = nearbyCells.nearest.front().second;
+	}
 
-	auto maxY = cellPosition.y + static_cast<int>(this->genes.radarRange.get() / 50 + 0.5);
-	if (maxY >= sectorsY) maxY = sectorsY - 1;
+	this->FoodCollisionVector.clear();
+	this->CellCollisionVector.clear();
 
-	//std::clog << minX << " " << minY << "   " << maxX << " " << maxY << std::endl;
+	if (!useList)
+	{
+		for (auto index : nearbyFood.contacts)
+			this->FoodCollisionVector.push_back(foods.getHandle(index));
+		for (auto index : nearbyCells.contacts)
+			this->CellCollisionVector.push_back(cells[index].get());
+		return;
+	}
 
-	//250000 is a max distance^2 what cell can "see"
-	double distance = this->genes.radarRange.get() * this->genes.radarRange.get();
-	for (int i = minX; i <= maxX; ++i)
+	if (buildList)
 	{
-		for (int j = minY; j <= maxY; ++j)
-		{
-			for (auto& food : foodSectors[i][j])
-			{
-				auto check = cellPtr->collision(food);
-				if (check.second < distance && !food->isMarkedToDelete())
-				{
-					this->closestFood.first = food;
-					this->closestFood.second = distance = check.second;
-				}
-				if (check.first && !food->isMarkedToDelete())
-				{
-					this->FoodCollisionVector->push_back(food);
-				}
-			}
-		}
+		neighbours.food.clear();
+		for (auto index : nearbyFood.contacts)
+			neighbours.food.push_back(foods.getHandle(index));
+
+		neighbours.cells.clear();
+		for (auto index : nearbyCells.contacts)
+			neighbours.cells.push_back(cells[index]->getHandle());
 	}
-}
 
-void Cell::calcCellCollisionVector()
-{
-	this->CellCollisionVector->clear();
-	auto& cellSectors = Environment::getInstance().getCellCollisionSectors();
-	const auto sectorsX = cellSectors.size();
-	const auto sectorsY = cellSectors[0].size();
+	// exact test of objects from list and objects created after rebuild
+	auto addFoodContact = [&](FoodHandle handle) {
+		auto food = foods.get(handle);
+		if (food == nullptr) return;
 
-	auto cellPtr = this->getSelfPtr();
-	auto cellPosition = Environment::getCollisionSectorCoords(cellPtr);
+		auto subPosition = environment.getDisplacement(food->position, position);
+		double distance = subPosition.x*subPosition.x + subPosition.y*subPosition.y;
+		auto sizes = size + food->size;
+		if (distance <= sizes * sizes)
+			this->FoodCollisionVector.push_back(handle);
+	};
 
-	auto minX = cellPosition.x - static_cast<int>(this->genes.radarRange.get() / 50 + 0.5);
-	if (minX < 0) minX = 0;
+	auto addCellContact = [&](Cell* cell) {
+		if (cell == nullptr || cell == this || cell->isDead() || cell->isMarkedToDelete()) return;
 
-	auto minY = cellPosition.y - static_cast<int>(this->genes.radarRange.get() / 50 + 0.5);
-	if (minY < 0) minY = 0;
+		auto subPosition = environment.getDisplacement(cell->getPosition(), position);
+		double distance = subPosition.x*subPosition.x + subPosition.y*subPosition.y;
+		auto sizes = size + cell->getSize();
+		if (distance <= sizes * sizes)
+			this->CellCollisionVector.push_back(cell);
+	};
 
-	auto maxX = cellPosition.x + static_cast<int>(this->genes.radarRange.get() / 50 + 0.5);
-	if (maxX >= sectorsX) maxX = sectorsX - 1;
+	for (auto handle : neighbours.food)
+		addFoodContact(handle);
+	for (auto handle : neighbourLists.getFreshFood())
+		addFoodContact(handle);
 
-	auto maxY = cellPosition.y + static_cast<int>(this->genes.radarRange.get() / 50 + 0.5);
-	if (maxY >= sectorsY) maxY = sectorsY - 1;
+	for (auto handle : neighbours.cells)
+		addCellContact(CellPool::getInstance().get(handle));
+	for (auto cell : neighbourLists.getFreshCells())
+		addCellContact(cell);
+}
 
-	//std::clog << minX << " " << minY << "   " << maxX << " " << maxY << std::endl;
+bool Cell::updateTrackedTargets()
+{
+	auto& environment = Environment::getInstance();
+	const auto position = getPosition();
+	const auto radarRange = getGenes().radarRange.get();
+	const auto rangeSquared = radarRange * radarRange;
 
-	//250000 is a max distance^2 what cell can "see"
-	double distance = this->genes.radarRange.get() * this->genes.radarRange.get();
-	for (int i = minX; i <= maxX; ++i)
+	if (closestFood.first.isValid())
 	{
-		for (int j = minY; j <= maxY; ++j)
-		{
-			for (auto& cell : cellSectors[i][j])
-			{
-				if (cell != cellPtr)
-				{
-					auto check = cellPtr->collision(cell);
-					if (check.second < distance && !cell->isMarkedToDelete())
-					{
-						this->closestCell.first = cell;
-						this->closestCell.second = distance = check.second;
-					}
-					if (check.first && !cell->isMarkedToDelete())
-					{
-						this->CellCollisionVector->push_back(std::dynamic_pointer_cast<Cell>(cell));
-					}
-				}
-			}
-		}
+		auto food = environment.getFoodStore().get(closestFood.first);
+		if (food == nullptr) return false;
+
+		auto subPosition = environment.getDisplacement(food->position, position);
+		double distance = subPosition.x*subPosition.x + subPosition.y*subPosition.y;
+		if (distance >= rangeSquared) return false;
+		closestFood.second = distance;
 	}
+
+	if (closestCell.first.isValid())
+	{
+		auto cell = CellPool::getInstance().get(closestCell.first);
+		if (cell == nullptr || cell->isDead() || cell->isMarkedToDelete()) return false;
+
+		auto subPosition = environment.getDisplacement(cell->getPosition(), position);
+		double distance = subPosition.x*subPosition.x + subPosition.y*subPosition.y;
+		if (distance >= rangeSquared) return false;
+		closestCell.second = distance;
+	}
+
+	return true;
 }
@@ -6,15 +6,21 @@
 #include <memory>
 #include <algorithm>
 #include "Logger.h"
-#include "Food.h"
+#include "FoodStore.h"
 #include "Genes.h"
 #include "Ranged.h"
 #include "MixDouble.h"
+#include "CellStore.h"
+#include "CellPool.h"
+#include "CollisionGrid.h"
+#include "NeighbourLists.h"
+#include "TickContext.h"
+#include "TextureProvider.h"
 
 
 class CellRoles;
 
-class Cell : public BaseObj
+class Cell final : public BaseObj
 {
 	friend class CellRoles;
 
@@ -30,25 +36,48 @@ public:
 	};
 
 	template <typename ... Types>
-	static std::shared_ptr<Cell> create(Types ... values);
+	static std::shared_ptr<Cell> create(Types&& ... values);
 
+	// copy gets its own CellStore row, moved cell takes row of the source over (Cell::create)
+	Cell(const Cell& other) = default;
+	Cell(Cell&& other) = default;
 	~Cell();
 
+	// sense and act with context of current step
 	void update();
 
+	// first phase of update - sensing role-functions, read-only for other objects (can run in parallel)
+	void sense(const TickContext& context);
+	// second phase of update - all other role-functions (sequential)
+	void act(const TickContext& context);
+
 	// for moving cell by user
 	void freeze();
 	void unfreeze();
+	bool isFreezed();
+
+	// id of role-functions set in CellRoles - cells with the same roles are updated together by environment
+	int getArchetype();
+	// false when roles changed since archetype was set (e.g. cell was killed) - does not register new archetype,
+	// so it is safe in parallel act phase
+	bool hasArchetype(int archetype);
+	// calls single role-function with random stream of this cell
+	void runRole(void(*role)(Cell*, const TickContext&), const TickContext& context);
+
+	// neighbour list used for contacts - see NeighbourLists
+	CellNeighbours& getNeighbours();
 
 	// Marks cell as killed. It will be moved to dead cells vector in next loop turn.
 	void kill();
 	bool isDead();
 
+	// stats below are kept in CellStore columns
 	Genes& getGenes();
 	void setGenes(Genes g);
 
 	double getFoodLevel();
 	double getCurrentSpeed();
+	double getAge();
 
 	void setCurrentSpeed(double speed);
 	void setFoodLevel(double foodLevel);
@@ -56,11 +85,10 @@ public:
 	void setHorniness(double horniness);
 	DynamicRanged<double>& getHorniness();
 
-	void dropRole(void(*role)(Cell*));
+	void dropRole(void(*role)(Cell*, const TickContext&));
 	void dropRoles();
-	void addRole(void(*role)(Cell*));
+	void addRole(void(*role)(Cell*, const TickContext&));
 
-	double age;
 	float delayTime;
 
 	// returns string with cell description that can be used to save cell from environment to file (contains current stats, position etc.)
@@ -77,56 +105,108 @@ public:
 
 	virtual void draw(sf::RenderTarget& target, sf::RenderStates states) const;
 
+	// fill colour of living cell = base colour + tint of environment (temperature, radiation) -
+	// set by environment before drawing, shape is touched only when resulting colour changed
+	void applyEnvironmentTint(const sf::Color& tint);
+
+	// colours depend on genes - they are recomputed by updateColor role after genes were changed
+	void invalidateColors();
+
+	// position, size and rotation are kept in CellStore only - shapes are updated from it when cell is drawn
+	sf::Vector2f getPosition();
 	void setPosition(const sf::Vector2f&);
 
+	float getSize();
 	void setSize(const float&);
 
+	float getRotation();
 	void setRotation(const float & r);
 	void rotate(const float & r);
+	// direction of movement for current rotation - unit vector
+	sf::Vector2<double> getHeading();
 
 	sf::CircleShape& getTypeShape();
 
 	std::shared_ptr<BaseObj> getClosestCell();
-	std::shared_ptr<BaseObj> getClosestFood();
+	// nullptr if food was eaten
+	Food* getClosestFood();
+
+	// invalid for cells not created by Cell::create (e.g. copies kept by tools)
+	CellHandle getHandle();
+
+	// row of this cell in CellStore - changes when store is compacted or reordered
+	size_t getStoreRow();
+
+	// random stream used by role-functions of this cell
+	void seedRandomStream(uint64_t seed, uint64_t streamId);
 
 private:
 	explicit Cell();
 	Cell(float size, sf::Vector2f position, sf::Color color);
-	Cell(Cell a, Cell b);
+	Cell(Cell& a, Cell& b);
 	Cell(std::string formattedCellString);
 
 	void modifyValueFromString(std::string valueName, std::string value);
 	void modifyValueFromVector(std::string valueName, const std::vector<std::string>& value);
 
 	// vector of pointers to role-functions
-	std::vector<void(*)(Cell*)> roles;
-
-	void calcFoodCollisionVector();
-	void calcCellCollisionVector();
-	// curent cell stats:
+	std::vector<void(*)(Cell*, const TickContext&)> roles;
+	// cached archetype of roles - reset when roles change
+	int archetype = -1;
 
-	double currentSpeed;
+	// fills food and cell collision vectors and closest food / cell in one neighbourhood query
+	// between rebuilds of neighbour lists contacts are tested only against the list
+	// closest targets are searched every Environment::getTargetSearchInterval() steps - tracked in between
+	void calcCollisionVectors();
+	/// \returns false if tracked target was eaten, killed or left radar range - distances of valid targets are updated
+	bool updateTrackedTargets();
+	CellPool::Registration registration;
 
-	double foodLevel;
+	// row of this cell in CellStore - position, rotation, size, speed, food level, age and genes
+	CellStore::Row row;
 
 	bool freezed = false;
 
 	bool dead = false;
 
-	Genes genes;
-
 	DynamicRanged<double> horniness; // <0,100>
 
 	std::string name;
 
 	sf::Color makedFoodColor;
 
-	sf::CircleShape typeShape;
-
-	std::shared_ptr<std::vector<std::shared_ptr<BaseObj>>> FoodCollisionVector = std::make_shared<std::vector<std::shared_ptr<BaseObj>>>();
-	std::shared_ptr<std::vector<std::shared_ptr<Cell>>> CellCollisionVector = std::make_shared<std::vector<std::shared_ptr<Cell>>>();
-	std::pair<std::shared_ptr<BaseObj>, double> closestCell;
-	std::pair<std::shared_ptr<BaseObj>, double> closestFood;
+	mutable sf::CircleShape typeShape;
+	// shapes do not match state in CellStore
+	mutable bool shapesOutdated = true;
+	void updateShapes() const;
+
+	// set on shape in updateShapes - textures are not needed until cell is drawn
+	TextureProvider::TextureId textureId = TextureProvider::noTexture;
+	void setTexture(const std::string& name);
+
+	// genes changed since colours were computed - see CellRoles::refreshColors
+	bool colorsOutdated = true;
+	// outline thickness follows size (set from genes), 0 - fixed thickness
+	float outlineThicknessPerSize = 0;
+
+	RandomStream randomStream;
+
+	// own for each cell (not shared with copies) - filled in sense phase
+	std::vector<FoodHandle> FoodCollisionVector;
+	// cells are not destroyed before end of step - raw pointers are valid until next sense phase
+	std::vector<Cell*> CellCollisionVector;
+	// set by fight / getingHot roles in act phase - used when contact pairs are resolved
+	bool readyToFight = false;
+	bool readyToMate = false;
+	// handle - closest cell can be read by tools between steps, after it was destroyed
+	std::pair<CellHandle, double> closestCell;
+	std::pair<FoodHandle, double> closestFood;
+	// results of last radar query - reused between steps
+	NearestQuery nearbyFood;
+	NearestQuery nearbyCells;
+	// steps left to next search of closest targets
+	int targetSearchCountdown = 0;
+	CellNeighbours neighbours;
 	float closestCellAngle;
 	float closestFoodAngle;
 
@@ -167,18 +247,88 @@ private:
 };
 
 template<typename ...Types>
-inline std::shared_ptr<Cell> Cell::create(Types ...values)
+inline std::shared_ptr<Cell> Cell::create(Types&& ...values)
 {
 	Cell::Ptr result;
 	try
 	{
-		result = std::make_shared<Cell>(Cell(values...));
+		// constructors are private - temporary is moved into shared block (no second row)
+		result = std::allocate_shared<Cell>(CellPool::Allocator<Cell>(), Cell(std::forward<Types>(values)...));
 	}
 	catch (std::exception e)
 	{
 		Logger::log(e.what());
-		result = std::make_shared<Cell>(Cell(20, { 0,0 }, sf::Color::White));
+		result = std::allocate_shared<Cell>(CellPool::Allocator<Cell>(), Cell(20, { 0,0 }, sf::Color::White));
 	}
 	result->setSelfPtr(result);
+	result->registration.acquire(result.get());
 	return result;
 }
+
+inline size_t Cell::getStoreRow()
+{
+	return row.get();
+}
+
+inline Genes & Cell::getGenes()
+{
+	return CellStore::getInstance().genes[row.get()];
+}
+
+inline void Cell::setGenes(Genes g)
+{
+	getGenes() = g;
+	invalidateColors();
+}
+
+inline double Cell::getFoodLevel()
+{
+	return CellStore::getInstance().foodLevel[row.get()];
+}
+
+inline double Cell::getCurrentSpeed()
+{
+	return CellStore::getInstance().speed[row.get()];
+}
+
+inline double Cell::getAge()
+{
+	return CellStore::getInstance().age[row.get()];
+}
+
+inline void Cell::setCurrentSpeed(double speed)
+{
+	CellStore::getInstance().speed[row.get()] = speed;
+}
+
+inline void Cell::setFoodLevel(double foodLevel)
+{
+	CellStore::getInstance().foodLevel[row.get()] = foodLevel;
+}
+
+inline void Cell::setAge(double age)
+{
+	CellStore::getInstance().age[row.get()] = age;
+}
+
+inline sf::Vector2f Cell::getPosition()
+{
+	auto& store = CellStore::getInstance();
+	return { store.positionX[row.get()], store.positionY[row.get()] };
+}
+
+inline float Cell::getSize()
+{
+	return CellStore::getInstance().radius[row.get()];
+}
+
+inline float Cell::getRotation()
+{
+	return CellStore::getInstance().rotation[row.get()];
+}
+
+inline sf::Vector2<double> Cell::getHeading()
+{
+	auto& store = CellStore::getInstance();
+	return { store.headingX[row.get()], store.headingY[row.get()] };
+}
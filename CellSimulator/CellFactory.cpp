@@ -1,6 +1,5 @@
 #include "CellFactory.h"
 #include "CellRoles.h"
-#include "TextureProvider.h"
 
 std::shared_ptr<Cell> CellFactory::getCell(Cell::Type type)
 {
@@ -11,65 +10,65 @@ std::shared_ptr<Cell> CellFactory::getCell(Cell::Type type)
 	switch (type)
 	{
 	case Cell::Type::Aggressive:
-		result->genes.aggresion = 90;
-		result->genes.divisionThreshold = 30;
-		result->genes.foodLimit = 120;
-		result->genes.maxAge = 90;
-		result->genes.maxSize = 35;
-		result->genes.maxSpeed = 2;
-		result->genes.radarRange = 350;
-		result->genes.type = 2;
+		result->getGenes().aggresion = 90;
+		result->getGenes().divisionThreshold = 30;
+		result->getGenes().foodLimit = 120;
+		result->getGenes().maxAge = 90;
+		result->getGenes().maxSize = 35;
+		result->getGenes().maxSpeed = 2;
+		result->getGenes().radarRange = 350;
+		result->getGenes().type = 2;
 		result->setFoodLevel(60);
 		result->setBaseColor(sf::Color::Red);
-		CellRoles::updateColor(result.get());
+		CellRoles::refreshColors(result.get());
 		break;
 
 	case Cell::Type::Passive:
-		result->genes.aggresion = 10;
-		result->genes.divisionThreshold = 25;
-		result->genes.foodLimit = 90;
-		result->genes.maxAge = 95;
-		result->genes.maxSize = 45;
-		result->genes.maxSpeed = 1;
-		result->genes.radarRange = 200;
-		result->genes.type = 1;
+		result->getGenes().aggresion = 10;
+		result->getGenes().divisionThreshold = 25;
+		result->getGenes().foodLimit = 90;
+		result->getGenes().maxAge = 95;
+		result->getGenes().maxSize = 45;
+		result->getGenes().maxSpeed = 1;
+		result->getGenes().radarRange = 200;
+		result->getGenes().type = 1;
 		result->setFoodLevel(60);
 		result->setBaseColor(sf::Color::Blue);
-		CellRoles::updateColor(result.get());
+		CellRoles::refreshColors(result.get());
 		break;
 
 	case Cell::Type::Speed:
-		result->genes.aggresion = 50;
-		result->genes.divisionThreshold = 90;
-		result->genes.foodLimit = 150;
-		result->genes.maxAge = 85;
-		result->genes.maxSize = 35;
-		result->genes.maxSpeed = 2;
-		result->genes.radarRange = 300;
-		result->genes.type = 0;
+		result->getGenes().aggresion = 50;
+		result->getGenes().divisionThreshold = 90;
+		result->getGenes().foodLimit = 150;
+		result->getGenes().maxAge = 85;
+		result->getGenes().maxSize = 35;
+		result->getGenes().maxSpeed = 2;
+		result->getGenes().radarRange = 300;
+		result->getGenes().type = 0;
 		result->setFoodLevel(60);
 		result->setBaseColor(sf::Color::Yellow);
-		CellRoles::updateColor(result.get());
+		CellRoles::refreshColors(result.get());
 		break;
 
 	case Cell::Type::Random:
 		g.randomize();
-		result->genes = g;
+		result->getGenes() = g;
 		result->setBaseColor(sf::Color::Yellow);
-		CellRoles::updateColor(result.get());
+		CellRoles::refreshColors(result.get());
 		break;
 
 	case Cell::Type::GreenLettuce:
-		result->genes.aggresion = 0;
-		result->genes.divisionThreshold = 45;
-		result->genes.foodLimit = 100;
-		result->genes.maxAge = 10;
-		result->genes.maxSize = 25;
-		result->genes.maxSpeed = 0.75;
-		result->genes.radarRange = 0;
-		result->genes.turningRate = 0.5;
-		result->genes.metabolism = 0.5;
-		result->genes.type = -1;
+		result->getGenes().aggresion = 0;
+		result->getGenes().divisionThreshold = 45;
+		result->getGenes().foodLimit = 100;
+		result->getGenes().maxAge = 10;
+		result->getGenes().maxSize = 25;
+		result->getGenes().maxSpeed = 0.75;
+		result->getGenes().radarRange = 0;
+		result->getGenes().turningRate = 0.5;
+		result->getGenes().metabolism = 0.5;
+		result->getGenes().type = -1;
 		result->dropRole(CellRoles::eat);
 		result->dropRole(CellRoles::simulateHunger);
 		result->dropRole(CellRoles::mutate);
@@ -84,21 +83,21 @@ std::shared_ptr<Cell> CellFactory::getCell(Cell::Type type)
 		result->setBaseColor(sf::Color::White);
 		result->setMakedFoodColor(sf::Color(8, 128, 8));
 		result->shape.setTextureRect(sf::IntRect{ 0,0,960,960 });
-		result->shape.setTexture(TextureProvider::getInstance().getTexture("greenLettuce").get());
+		result->setTexture("greenLettuce");
 		result->typeShape.setFillColor(sf::Color::Transparent);
 		break;
 
 	case Cell::Type::Pizza:
-		result->genes.aggresion = 0;
-		result->genes.divisionThreshold = 45;
-		result->genes.foodLimit = 150;
-		result->genes.maxAge = 10;
-		result->genes.maxSize = 45;
-		result->genes.maxSpeed = 0.5;
-		result->genes.radarRange = 0;
-		result->genes.metabolism = 0.2;
-		result->genes.turningRate = 0.5;
-		result->genes.type = -1;
+		result->getGenes().aggresion = 0;
+		result->getGenes().divisionThreshold = 45;
+		result->getGenes().foodLimit = 150;
+		result->getGenes().maxAge = 10;
+		result->getGenes().maxSize = 45;
+		result->getGenes().maxSpeed = 0.5;
+		result->getGenes().radarRange = 0;
+		result->getGenes().metabolism = 0.2;
+		result->getGenes().turningRate = 0.5;
+		result->getGenes().type = -1;
 		result->dropRole(CellRoles::eat);
 		result->dropRole(CellRoles::simulateHunger);
 		result->dropRole(CellRoles::mutate);
@@ -113,21 +112,21 @@ std::shared_ptr<Cell> CellFactory::getCell(Cell::Type type)
 		result->setBaseColor(sf::Color::White);
 		result->setMakedFoodColor(sf::Color(224, 144, 33, 255));
 		result->shape.setTextureRect(sf::IntRect{ 0,0,1052,1052 });
-		result->shape.setTexture(TextureProvider::getInstance().getTexture("pizza").get());
+		result->setTexture("pizza");
 		result->typeShape.setFillColor(sf::Color::Transparent);
 		result->setSize(45);
 		break;
 	case Cell::Type::Default:
-		result->genes.aggresion = 50;
-		result->genes.divisionThreshold = 50;
-		result->genes.foodLimit = 75;
-		result->genes.maxAge = 50;
-		result->genes.maxSize = 35;
-		result->genes.maxSpeed = 1.0;
-		result->genes.radarRange = 250;
-		result->genes.metabolism = 1.0;
-		result->genes.type = 0;
-		result->genes.turningRate = 3.25;
+		result->getGenes().aggresion = 50;
+		result->getGenes().divisionThreshold = 50;
+		result->getGenes().foodLimit = 75;
+		result->getGenes().maxAge = 50;
+		result->getGenes().maxSize = 35;
+		result->getGenes().maxSpeed = 1.0;
+		result->getGenes().radarRange = 250;
+		result->getGenes().metabolism = 1.0;
+		result->getGenes().type = 0;
+		result->getGenes().turningRate = 3.25;
 		result->setBaseColor(sf::Color::White);
 		result->setFoodLevel(60);
 		result->setSize(20);
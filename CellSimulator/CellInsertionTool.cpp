@@ -70,7 +70,7 @@ void CellInsertionTool::setCellBlueprint(Cell::Ptr cell)
 
 	auto newCell = Cell::create(*cell);
 	if (cell->getGenes().type.get() != -1)
-		CellRoles::updateColor(newCell.get());
+		CellRoles::refreshColors(newCell.get());
 	newCell->freeze();
 	newCell->setRotation(0);
 	cellBlueprint = newCell;
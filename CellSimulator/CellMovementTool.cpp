@@ -131,6 +131,9 @@ void CellMovementTool::pickCellFromEnvironment()
 		auto cellToPick = std::find(cells.begin(), cells.end(), selectedCell);
 		if (cellToPick != cells.end())
 			cells.erase(cellToPick);
+
+		// picked cell is still in neighbour lists of other cells
+		Environment::getInstance().getNeighbourLists().invalidate();
 	}
 }
 
@@ -0,0 +1,144 @@
+#include "CellPool.h"
+#include <cstddef>
+#include <new>
+#include "Logger.h"
+
+namespace
+{
+	// pool can be destroyed at exit before singletons that still keep cells
+	bool poolDestroyed = false;
+}
+
+CellPool::Registration::~Registration()
+{
+	if (handle.isValid() && !poolDestroyed)
+		CellPool::getInstance().releaseHandle(handle);
+}
+
+void CellPool::Registration::acquire(Cell * owner)
+{
+	if (!handle.isValid())
+		handle = CellPool::getInstance().acquireHandle(owner);
+}
+
+CellPool::CellPool() : blockSize(0)
+{
+}
+
+CellPool::~CellPool()
+{
+	poolDestroyed = true;
+
+	// cells still alive in other singletons are destroyed later - slabs are left to the OS
+	for (auto& slab : slabs)
+		slab.release();
+}
+
+CellPool & CellPool::getInstance()
+{
+	static CellPool instance;
+	return instance;
+}
+
+Cell * CellPool::get(CellHandle handle)
+{
+	if (!handle.isValid()) return nullptr;
+
+	auto index = handle.getIndex();
+	if (index >= slots.size() || slots[index].generation != handle.getGeneration())
+		return nullptr;
+	return slots[index].cell;
+}
+
+size_t CellPool::getAliveCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return slots.size() - freeSlots.size();
+}
+
+CellHandle CellPool::acquireHandle(Cell * cell)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	uint32_t index;
+	if (!freeSlots.empty())
+	{
+		index = freeSlots.front();
+		freeSlots.pop_front();
+	}
+	else
+	{
+		if (slots.size() > CellHandle::indexMask)
+		{
+			Logger::log("Cell limit reached.");
+			return CellHandle();
+		}
+
+		index = static_cast<uint32_t>(slots.size());
+		slots.push_back(Slot{ nullptr, 0 });
+	}
+
+	slots[index].cell = cell;
+	return CellHandle(index, slots[index].generation);
+}
+
+void CellPool::releaseHandle(CellHandle handle)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto& slot = slots[handle.getIndex()];
+	slot.cell = nullptr;
+	// all handles to this slot become stale
+	slot.generation = CellHandle::nextGeneration(handle.getIndex(), slot.generation);
+
+	freeSlots.push_back(handle.getIndex());
+}
+
+void * CellPool::allocateBlock(size_t size, size_t alignment)
+{
+	if (alignment > alignof(std::max_align_t))
+		return ::operator new(size);
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (blockSize == 0)
+		blockSize = (size + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+	// other sizes (e.g. allocation of another type) - regular heap
+	if (size > blockSize || blockSize - size >= alignof(std::max_align_t))
+		return ::operator new(size);
+
+	if (freeBlocks.empty())
+	{
+		slabs.emplace_back(new unsigned char[blockSize * blocksPerSlab]);
+		auto slab = slabs.back().get();
+		// reversed - blocks are taken from the beginning of slab
+		for (size_t i = blocksPerSlab; i > 0; --i)
+			freeBlocks.push_back(slab + (i - 1) * blockSize);
+	}
+
+	auto block = freeBlocks.back();
+	freeBlocks.pop_back();
+	return block;
+}
+
+void CellPool::deallocateBlock(void * p, size_t size, size_t alignment)
+{
+	if (poolDestroyed) return;
+
+	if (alignment > alignof(std::max_align_t))
+	{
+		::operator delete(p);
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (blockSize == 0 || size > blockSize || blockSize - size >= alignof(std::max_align_t))
+	{
+		::operator delete(p);
+		return;
+	}
+
+	freeBlocks.push_back(p);
+}
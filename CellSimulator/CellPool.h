@@ -0,0 +1,106 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include "Handle.h"
+
+class Cell;
+
+using CellHandle = Handle<Cell>;
+
+// Memory and handles of cells.
+// Cells are allocated from fixed size slabs (Cell::create uses CellPool::Allocator) - memory
+// of dead cells is reused by newborn ones instead of going back to heap.
+class CellPool final
+{
+public:
+	// handle of cell created by Cell::create - copies of cell are not registered
+	class Registration final
+	{
+	public:
+		Registration() {}
+		Registration(const Registration&) {}
+		Registration& operator=(const Registration&) { return *this; }
+		~Registration();
+
+		void acquire(Cell* owner);
+		CellHandle get() const { return handle; }
+
+	private:
+		CellHandle handle;
+	};
+
+	// allocator for std::allocate_shared - single objects come from slabs
+	template <typename T>
+	class Allocator
+	{
+	public:
+		using value_type = T;
+
+		Allocator() = default;
+		template <typename U>
+		Allocator(const Allocator<U>&) {}
+
+		T* allocate(size_t n);
+		void deallocate(T* p, size_t n);
+
+		template <typename U>
+		bool operator==(const Allocator<U>&) const { return true; }
+		template <typename U>
+		bool operator!=(const Allocator<U>&) const { return false; }
+	};
+
+	~CellPool();
+	static CellPool& getInstance();
+
+	// nullptr if cell was destroyed
+	// not locked - cells must not be created or destroyed concurrently (true in sense and act phases)
+	Cell* get(CellHandle handle);
+
+	size_t getAliveCount();
+
+private:
+	CellPool();
+	CellPool(const CellPool&) = delete;
+	CellPool& operator=(const CellPool&) = delete;
+
+	CellHandle acquireHandle(Cell* cell);
+	void releaseHandle(CellHandle handle);
+
+	void* allocateBlock(size_t size, size_t alignment);
+	void deallocateBlock(void* p, size_t size, size_t alignment);
+
+	struct Slot
+	{
+		Cell* cell;
+		uint32_t generation;
+	};
+
+	std::vector<Slot> slots;
+	// FIFO - released slot is reused after all other free slots
+	std::deque<uint32_t> freeSlots;
+
+	// slabs of one block size - allocate_shared needs only one (control block + cell)
+	static constexpr size_t blocksPerSlab = 256;
+	size_t blockSize;
+	std::vector<std::unique_ptr<unsigned char[]>> slabs;
+	std::vector<void*> freeBlocks;
+
+	std::mutex mutex;
+};
+
+template<typename T>
+inline T * CellPool::Allocator<T>::allocate(size_t n)
+{
+	if (n != 1) return std::allocator<T>().allocate(n);
+	return static_cast<T*>(CellPool::getInstance().allocateBlock(sizeof(T), alignof(T)));
+}
+
+template<typename T>
+inline void CellPool::Allocator<T>::deallocate(T * p, size_t n)
+{
+	if (n != 1) std::allocator<T>().deallocate(p, n);
+	else CellPool::getInstance().deallocateBlock(p, sizeof(T), alignof(T));
+}
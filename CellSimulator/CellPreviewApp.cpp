@@ -242,10 +242,10 @@ void CellPreviewApp::update()
 			//age
 			ageValTT->setText("Min: " + doubleToString(cell->getGenes().maxAge.getMin(),2) + "\nMax: " + doubleToString(cell->getGenes().maxAge.get(),2));
 			ageVal->setVisible(1);
-			ageVal->setText(doubleToString(cell->age,2));
+			ageVal->setText(doubleToString(cell->getAge(),2));
 			ageVal->setMaximum(cell->getGenes().maxAge.get() * 100);
 			ageVal->setMinimum(cell->getGenes().maxAge.getMin() * 100);
-			ageVal->setValue(cell->age * 100);
+			ageVal->setValue(cell->getAge() * 100);
 			//horniness
 			horninessValTT->setText("Min: " + doubleToString(cell->getHorniness().getMin(),2) + "\nMax: " + doubleToString(cell->getHorniness().getMax(),2));
 			horninessVal->setVisible(1);
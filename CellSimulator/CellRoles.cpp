@@ -2,8 +2,6 @@
 #include "Random.h"
 #include "Environment.h"
 #include "Logger.h"
-#include "CellSimApp.h"
-#include "CellSelectionTool.h"
 #include "Distance.h"
 #include "RangeChecker.h"
 constexpr double PI = 3.14159265358979323846;
@@ -51,56 +49,124 @@ CellRoles & CellRoles::getManager()
 }
 
 
-void CellRoles::moveForward(Cell * c)
+void CellRoles::moveForward(Cell * c, const TickContext& context)
 {
-	auto cellPtr = c->getSelfPtr();
-	const auto prevPosition = c->getPosition();
-	const auto prevCollisionSectorCoords = Environment::getCollisionSectorCoords(cellPtr);
+	// environment moves whole groups - single cell is moved the same way
+	moveForwardBatch(&c, 1, c->getArchetype(), context);
+}
+
+void CellRoles::moveForwardBatch(Cell* const* cells, size_t count, int archetype, const TickContext& context)
+{
+	auto& store = CellStore::getInstance();
+	// chunks of one group are moved by many threads
+	static thread_local MoveBuffers buffers;
 
-	auto moveSpeed = (Environment::getInstance().getTemperature() + 100) / 100 * c->currentSpeed;
-	c->shape.move(moveSpeed * std::sin((PI / 180)*c->getRotation()) * CellSimApp::getInstance().getDeltaTime(), moveSpeed * -std::cos((PI / 180)*c->getRotation()) * CellSimApp::getInstance().getDeltaTime());
-	c->typeShape.setPosition(c->getPosition());
+	// the same for all cells in act phase
+	const double temperatureFactor = (context.temperature + 100) / 100;
+	const double deltaTime = context.deltaTime;
+	const auto envSize = context.envSize;
+	const bool wrap = context.wrap;
 
-	for (int attempt = 0; checkEnvironmentBounds(c); ++attempt)
+	// state of cells packed in order of cells - new positions are computed in one loop without branches
+	// (conditions are selects, not jumps), which compiler vectorizes
+	buffers.resize(count);
+
+	for (size_t i = 0; i < count; ++i)
 	{
-		c->shape.setPosition(prevPosition);
-		c->shape.setRotation(c->getRotation() + (randomInt(0,1) == 0 ? -90 : 90));
-		c->shape.move(moveSpeed * std::sin((PI / 180)*c->getRotation()) * CellSimApp::getInstance().getDeltaTime(), moveSpeed * -std::cos((PI / 180)*c->getRotation()) * CellSimApp::getInstance().getDeltaTime());
-		c->typeShape.setPosition(c->getPosition());
+		auto row = cells[i]->getStoreRow();
+		buffers.x[i] = store.positionX[row];
+		buffers.y[i] = store.positionY[row];
+		buffers.radius[i] = store.radius[row];
+		buffers.speed[i] = store.speed[row];
+		buffers.headingX[i] = store.headingX[row];
+		buffers.headingY[i] = store.headingY[row];
+	}
 
-		if (attempt > 5) { c->setPosition(Environment::getInstance().getSize() / 2.f); break; }
+	if (wrap)
+	{
+		// one step is shorter than environment - single shift, tiny negative values rounded to size belong to 0
+		for (size_t i = 0; i < count; ++i)
+		{
+			double moveSpeed = temperatureFactor * buffers.speed[i];
+			float x = buffers.x[i] + static_cast<float>(moveSpeed * buffers.headingX[i] * deltaTime);
+			float y = buffers.y[i] + static_cast<float>(moveSpeed * buffers.headingY[i] * deltaTime);
+			x += x < 0 ? envSize.x : 0.0f;
+			x -= x >= envSize.x ? envSize.x : 0.0f;
+			y += y < 0 ? envSize.y : 0.0f;
+			y -= y >= envSize.y ? envSize.y : 0.0f;
+			buffers.x[i] = x;
+			buffers.y[i] = y;
+			buffers.mirrored[i] = 0;
+		}
+	}
+	else
+	{
+		// cell moving out through border is reflected back and its heading is mirrored,
+		// cell that already overlaps border (e.g. inserted by user) is only clamped
+		for (size_t i = 0; i < count; ++i)
+		{
+			double moveSpeed = temperatureFactor * buffers.speed[i];
+			float x = buffers.x[i] + static_cast<float>(moveSpeed * buffers.headingX[i] * deltaTime);
+			float y = buffers.y[i] + static_cast<float>(moveSpeed * buffers.headingY[i] * deltaTime);
+			float low = buffers.radius[i];
+			float highX = envSize.x - low;
+			float highY = envSize.y - low;
+
+			bool outX = (x < low && buffers.headingX[i] < 0) || (x > highX && buffers.headingX[i] > 0);
+			bool outY = (y < low && buffers.headingY[i] < 0) || (y > highY && buffers.headingY[i] > 0);
+			x = outX ? (x < low ? 2 * low - x : 2 * highX - x) : x;
+			y = outY ? (y < low ? 2 * low - y : 2 * highY - y) : y;
+
+			buffers.x[i] = std::min(std::max(x, low), highX);
+			buffers.y[i] = std::min(std::max(y, low), highY);
+			buffers.mirrored[i] = static_cast<uint8_t>((outX ? 1 : 0) | (outY ? 2 : 0));
+		}
 	}
 
-	// update collision sectors
-	const auto currentCollisionSectorCoords = Environment::getCollisionSectorCoords(c->getSelfPtr());
-	if (prevCollisionSectorCoords != currentCollisionSectorCoords)
+	for (size_t i = 0; i < count; ++i)
 	{
-		auto& sectors = Environment::getInstance().getCellCollisionSectors();
-		auto& prevCVect = sectors[prevCollisionSectorCoords.x][prevCollisionSectorCoords.y];
-		auto& currCVect = sectors[currentCollisionSectorCoords.x][currentCollisionSectorCoords.y];
+		auto c = cells[i];
+		// roles changed during this step (e.g. cell was killed)
+		if (!c->hasArchetype(archetype)) continue;
+
+		c->setPosition(sf::Vector2f(buffers.x[i], buffers.y[i]));
 
-		prevCVect.erase(std::remove(prevCVect.begin(), prevCVect.end(), cellPtr), prevCVect.end());
-		currCVect.push_back(cellPtr);
+		// mirrored x of heading = -rotation, mirrored y = 180 - rotation, both = 180 + rotation
+		auto mirrored = buffers.mirrored[i];
+		if (mirrored == 1) c->setRotation(-c->getRotation());
+		else if (mirrored == 2) c->setRotation(180 - c->getRotation());
+		else if (mirrored == 3) c->setRotation(180 + c->getRotation());
 	}
 }
 
-void CellRoles::changeDirection(Cell * c)
+void CellRoles::MoveBuffers::resize(size_t count)
+{
+	x.resize(count);
+	y.resize(count);
+	radius.resize(count);
+	speed.resize(count);
+	headingX.resize(count);
+	headingY.resize(count);
+	mirrored.resize(count);
+}
+
+void CellRoles::changeDirection(Cell * c, const TickContext& context)
 {
-	if (c->genes.type.get() == 1 && c->closestFood.first != nullptr && c->closestFoodAngle != 0)
+	if (c->getGenes().type.get() == 1 && c->closestFood.first.isValid() && c->closestFoodAngle != 0)
 	{
 		c->rotate(c->closestFoodAngle);
 	}
-	else if (c->genes.type.get() == 2 && c->closestCell.first != nullptr && c->closestCellAngle != 0)
+	else if (c->getGenes().type.get() == 2 && c->closestCell.first.isValid() && c->closestCellAngle != 0)
 	{
 		c->rotate(c->closestCellAngle);
 	}
-	else if (c->genes.type.get() == 0 && (c->closestFood.first != nullptr || c->closestCell.first != nullptr) && (c->closestFoodAngle != 0 || c->closestCellAngle != 0))
+	else if (c->getGenes().type.get() == 0 && (c->closestFood.first.isValid() || c->closestCell.first.isValid()) && (c->closestFoodAngle != 0 || c->closestCellAngle != 0))
 	{
-		if (c->closestFood.first != nullptr && c->closestCell.first == nullptr && c->closestFoodAngle != 0)
+		if (c->closestFood.first.isValid() && !c->closestCell.first.isValid() && c->closestFoodAngle != 0)
 		{
 			c->rotate(c->closestFoodAngle);
 		}
-		else if (c->closestFood.first == nullptr && c->closestCell.first != nullptr && c->closestCellAngle != 0)
+		else if (!c->closestFood.first.isValid() && c->closestCell.first.isValid() && c->closestCellAngle != 0)
 		{
 			c->rotate(c->closestCellAngle);
 		}
@@ -134,41 +200,44 @@ void CellRoles::changeDirection(Cell * c)
 	}
 }
 
-void CellRoles::changeSpeed(Cell * c)
+void CellRoles::changeSpeed(Cell * c, const TickContext& context)
 {
 	// SPEED CHANGE THRESHOLD SHOULD BE STORED IN GENES
 	if (randomInt(0, 1000) > 995)
-		c->currentSpeed = randomReal(0.1, static_cast<float>(c->genes.maxSpeed.get()));
+		c->setCurrentSpeed(randomReal(0.1, static_cast<float>(c->getGenes().maxSpeed.get())));
 }
 
-void CellRoles::eat(Cell * c)
+void CellRoles::eat(Cell * c, const TickContext& context)
 {
-	if (c->genes.type.get() == 2) return;
+	if (c->getGenes().type.get() == 2) return;
 
-	auto& foods = Environment::getInstance().getFoodsVector();
+	auto& foods = Environment::getInstance().getFoodStore();
 	auto& collisions = c->FoodCollisionVector;
 
-	for (auto& f : *collisions)
+	for (auto& handle : collisions)
 	{
-		if (c->foodLevel < c->genes.foodLimit.get())
+		// nullptr - already eaten by other cell in this step
+		auto f = foods.get(handle);
+		if (c->getFoodLevel() < c->getGenes().foodLimit.get() && f != nullptr)
 		{
-			c->foodLevel += static_cast<float>(f->getSize());
-			f->markToDelete();
-
-			// update collision sectors
-			const auto currentCollisionSectorCoords = Environment::getCollisionSectorCoords(f);
-
-			auto& sectors = Environment::getInstance().getCellCollisionSectors();
-			auto& foodCollisionSector = sectors[currentCollisionSectorCoords.x][currentCollisionSectorCoords.y];
-
-			foodCollisionSector.erase(std::remove(foodCollisionSector.begin(), foodCollisionSector.end(), f), foodCollisionSector.end());
+			c->setFoodLevel(c->getFoodLevel() + static_cast<float>(f->size));
+			Environment::getInstance().removeFood(handle);
 		}
 	}
 }
 
-void CellRoles::updateColor(Cell * c)
+void CellRoles::updateColor(Cell * c, const TickContext& context)
+{
+	// colours depend on genes only - tint of environment is added when cell is drawn
+	if (c->colorsOutdated)
+		refreshColors(c);
+}
+
+void CellRoles::refreshColors(Cell * c)
 {
-	if (c->genes.type.get() != -1)
+	c->colorsOutdated = false;
+
+	if (c->getGenes().type.get() != -1)
 	{
 		auto& genes = c->getGenes();
 		double aggression = genes.aggresion.get() / (genes.aggresion.getMax() - genes.aggresion.getMin());
@@ -206,21 +275,21 @@ void CellRoles::updateColor(Cell * c)
 			outlineColor = sf::Color(255 * maxSpeed, 255 * maxSpeed, 0, 80);
 		}
 
-		if (c->genes.type.get() == 0)
+		if (c->getGenes().type.get() == 0)
 		{
 			c->typeShape.setFillColor(sf::Color(192, 0, 0, 100));
 			c->typeShape.setPointCount(7);
 			c->typeShape.setOutlineThickness(-2);
 			c->typeShape.setOutlineColor(sf::Color(192, 192, 128));
 		}
-		else if (c->genes.type.get() == 1)
+		else if (c->getGenes().type.get() == 1)
 		{
 			c->typeShape.setFillColor(sf::Color(0, 192, 0, 100));
 			c->typeShape.setPointCount(4);
 			c->typeShape.setOutlineThickness(-2);
 			c->typeShape.setOutlineColor(sf::Color(192, 192, 128));
 		}
-		else if (c->genes.type.get() == 2)
+		else if (c->getGenes().type.get() == 2)
 		{
 			c->typeShape.setFillColor(sf::Color(0, 0, 192, 100));
 			c->typeShape.setPointCount(3);
@@ -230,7 +299,9 @@ void CellRoles::updateColor(Cell * c)
 
 		c->setBaseColor(bodyColor);
 		c->setOutlineColor(outlineColor);
-		c->setOutlineThickness(c->getSize()*0.7*foodLimit*(-1));
+		// thickness is updated with size when shapes are drawn
+		c->outlineThicknessPerSize = static_cast<float>(0.7*foodLimit*(-1));
+		c->setOutlineThickness(c->getSize()*c->outlineThicknessPerSize);
 	}
 	else
 	{
@@ -241,38 +312,12 @@ void CellRoles::updateColor(Cell * c)
 
 		c->setBaseColor(sf::Color::White);
 		c->setOutlineColor(sf::Color::White);
+		c->outlineThicknessPerSize = 0;
 		c->setOutlineThickness(0);
 	}
-	// ENVIRONMENT INFLUENCE
-	constexpr double threshold = 30;
-	Ranged<int, 0, 255> newR, newG, newB;
-	auto newColor = c->getBaseColor();
-
-	//temperature
-	auto& envTemp = Environment::getInstance().getTemperature();
-	auto& envRad = Environment::getInstance().getRadiation();
-	if (envTemp > threshold)
-	{
-		newR = 2 * abs(envTemp - threshold) + c->getBaseColor().r;
-		newColor.r = newR.get();
-	}
-	else if (envTemp < -threshold)
-	{
-		newB = 2 * abs(envTemp + threshold) + c->getBaseColor().b;
-		newColor.b = newB.get();
-	}
-
-	//radiation
-	if (envRad > threshold)
-	{
-		newG = 3 * abs(envRad - threshold) + c->getBaseColor().g;
-		newColor.g = newG.get();
-	}
-
-	c->shape.setFillColor(newColor);
 }
 
-void CellRoles::beDead(Cell * c)
+void CellRoles::beDead(Cell * c, const TickContext& context)
 {
 	auto color = c->shape.getFillColor();
 	auto color2 = c->shape.getOutlineColor();
@@ -280,7 +325,7 @@ void CellRoles::beDead(Cell * c)
 	auto color4 = c->typeShape.getOutlineColor();
 	if (color.a > 0)
 	{
-		double a = static_cast<double>(color.a) - ((Environment::getInstance().getTemperature() + 100 + 1)*0.01*CellSimApp::getInstance().getDeltaTime());
+		double a = static_cast<double>(color.a) - ((context.temperature + 100 + 1)*0.01*context.deltaTime);
 		if (0 > a) a = 0;
 		color.a = a;
 		color2.a = a;
@@ -297,83 +342,68 @@ void CellRoles::beDead(Cell * c)
 	}
 }
 
-void CellRoles::simulateHunger(Cell * c) {
-	c->foodLevel -= 0.025 * CellSimApp::getInstance().getDeltaTime() * c->genes.metabolism.get() * c->currentSpeed * c->getSize() / 10;
-	if (c->foodLevel <= 0)
+void CellRoles::simulateHunger(Cell * c, const TickContext& context) {
+	c->setFoodLevel(c->getFoodLevel() - 0.025 * context.deltaTime * c->getGenes().metabolism.get() * c->getCurrentSpeed() * c->getSize() / 10);
+	if (c->getFoodLevel() <= 0)
 	{
 		c->kill();
 	}
 }
 
-void CellRoles::divideAndConquer(Cell * c)
+void CellRoles::divideAndConquer(Cell * c, const TickContext& context)
 {
-	auto& cells = Environment::getInstance().getCellsVector();
-	if (c->foodLevel >= c->genes.foodLimit.get() && c->getSize() >= c->genes.maxSize.get() && randomInt(0, 100) <= c->genes.divisionThreshold.get())
+	if (c->getFoodLevel() >= c->getGenes().foodLimit.get() && c->getSize() >= c->getGenes().maxSize.get() && randomInt(0, 100) <= c->getGenes().divisionThreshold.get())
 	{
-		c->foodLevel -= c->genes.foodLimit.get() / 2;
-		c->setSize(c->genes.maxSize.get() / 2);
+		c->setFoodLevel(c->getFoodLevel() - c->getGenes().foodLimit.get() / 2);
+		c->setSize(c->getGenes().maxSize.get() / 2);
 		auto ptr = Cell::create(*c);
-		ptr->age = 0;
+		ptr->setAge(0);
 		Environment::getInstance().insertNewCell(ptr);
 		c->setRotation(c->getRotation() + 180);
 	}
 }
 
-void CellRoles::grow(Cell * c)
+void CellRoles::grow(Cell * c, const TickContext& context)
 {
 	auto rand = randomReal(0.0005, 0.025);
 
 	auto prevSize = c->getSize();
 
 	// grow
-	if (c->getSize() < c->genes.maxSize.get() && c->foodLevel >= c->genes.foodLimit.get()*0.90)
+	if (c->getSize() < c->getGenes().maxSize.get() && c->getFoodLevel() >= c->getGenes().foodLimit.get()*0.90)
 	{
-		c->setSize(c->getSize() + (rand * CellSimApp::getInstance().getDeltaTime()));
-		if (checkEnvironmentBounds(c))
+		c->setSize(c->getSize() + (rand * context.deltaTime));
+		if (checkEnvironmentBounds(c, context))
 		{
 			c->setSize(prevSize);
 		}
 	}
 	// grow in other direction
-	else if (c->getSize() > 15 && c->foodLevel <= c->genes.foodLimit.get()*0.25)
+	else if (c->getSize() > 15 && c->getFoodLevel() <= c->getGenes().foodLimit.get()*0.25)
 	{
-		c->setSize(c->getSize() - (rand * CellSimApp::getInstance().getDeltaTime()));
+		c->setSize(c->getSize() - (rand * context.deltaTime));
 	}
 }
 
-void CellRoles::getingHot(Cell * c)
+void CellRoles::getingHot(Cell * c, const TickContext& context)
 {
-	if (c->foodLevel >= c->genes.foodLimit.get()*0.75)
+	if (c->getFoodLevel() >= c->getGenes().foodLimit.get()*0.75)
 	{
-		c->setHorniness(c->getHorniness().get() + (randomReal(0.01, 0.05)*CellSimApp::getInstance().getDeltaTime()));
+		c->setHorniness(c->getHorniness().get() + (randomReal(0.01, 0.05)*context.deltaTime));
 	}
 
+	// partner is searched when contact pairs are resolved - see resolveContactPair
 	if (c->horniness.isMax())
-	{
-		auto & cells = c->CellCollisionVector;
-		for (auto & cell : *cells)
-		{
-			if (cell.get() != c && !cell->isDead() && cell->getHorniness().isMax() && c->genes.type.get() == cell->genes.type.get())
-			{
-				c->setHorniness(0);
-				c->foodLevel = c->genes.foodLimit.get() / 2;
-				cell->setHorniness(0);
-				cell->foodLevel = c->genes.foodLimit.get() / 2;
-				std::shared_ptr<Cell> tmp = Cell::create(*c, *cell);
-				tmp->age = 0;
-				Environment::getInstance().insertNewCell(tmp);
-			}
-		}
-	}
+		c->readyToMate = true;
 }
 
-void CellRoles::makeFood(Cell * c)
+void CellRoles::makeFood(Cell * c, const TickContext& context)
 {
-	c->foodLevel += randomReal(0.1, 0.5) * c->genes.metabolism.get() * CellSimApp::getInstance().getDeltaTime();
+	c->setFoodLevel(c->getFoodLevel() + randomReal(0.1, 0.5) * c->getGenes().metabolism.get() * context.deltaTime);
 
-	if (c->foodLevel >= c->genes.foodLimit.get())
+	if (c->getFoodLevel() >= c->getGenes().foodLimit.get())
 	{
-		c->foodLevel = 0;
+		c->setFoodLevel(0);
 		auto size = c->getSize();
 
 		int foods = randomInt(0, 100) > 90 ? 2 : 1;
@@ -391,8 +421,7 @@ void CellRoles::makeFood(Cell * c)
 			foodColor.r = randomInt(foodColor.r - margin, foodColor.r + margin);
 			foodColor.g = randomInt(foodColor.g - margin, foodColor.g + margin);
 			foodColor.b = randomInt(foodColor.b - margin, foodColor.b + margin);
-			auto food = Food::create(foodSize, position, foodColor, foodSize);
-			Environment::getInstance().insertNewFood(food);
+			Environment::getInstance().insertNewFood(Food(foodSize, position, foodColor, foodSize));
 
 			c->horniness = 0;
 		}
@@ -400,124 +429,130 @@ void CellRoles::makeFood(Cell * c)
 
 }
 
-void CellRoles::fight(Cell * c)
+void CellRoles::fight(Cell * c, const TickContext& context)
 {
-	if (c->genes.type.get() == 1) return;
+	if (c->getGenes().type.get() == 1) return;
 
-	auto &cells = c->CellCollisionVector;
-	c->delayTime += CellSimApp::getInstance().getDeltaTime();
+	c->delayTime += context.deltaTime;
 
+	// opponents are fought when contact pairs are resolved - see resolveContactPair
 	if (c->delayTime > 250)
 	{
 		c->delayTime = 0;
-		for (auto& cell : *cells)
-		{
-			if (cell->getGenes().type.get() != c->getGenes().type.get()) {
-
-				cell->delayTime = 0;
-
-				double sizeWeight = 0.2;
-				double agressionWeight = 0.4;
-				double randomWeight = 0.4;
-
-				if (c->getSize() * sizeWeight + c->getGenes().aggresion.get() * agressionWeight + randomInt(1, 20) * randomWeight >
-					cell->getSize() * sizeWeight + cell->getGenes().aggresion.get() * agressionWeight + randomInt(1, 20) * randomWeight)
-				{
-					cell->setSize(cell->getSize() - 2);
-					if (c->getFoodLevel() + 2 < c->getGenes().foodLimit.get())
-					{
-						c->foodLevel += 10;
-					}
-
-				}
-				else
-				{
-					c->setSize(c->getSize() - 2);
-					if (cell->getFoodLevel() + 2 < cell->getGenes().foodLimit.get())
-					{
-						cell->foodLevel += 10;
-					}
-				}
-
-				if (c->getSize() < 5)
-				{
-					c->kill();
-				}
-				if (cell->getSize() < 5)
-				{
-					cell->kill();
-				}
-			}
+		c->readyToFight = true;
+	}
+}
 
-			/*float cSize = c->getSize();
-			float cellSize = cell->getSize();
-			int sizeDelta = 2;
+void CellRoles::collectContactPairs(Cell * c, std::vector<std::pair<Cell*, Cell*>>& pairs)
+{
+	c->readyToFight = false;
+	c->readyToMate = false;
 
-			if (cSize > cellSize) {
-				c->setSize(cSize - sizeDelta);
-				cell->setSize(cellSize + sizeDelta);
-				cell->foodLevel += sizeDelta;
-			}
-			else if (cSize < cellSize) {
-				c->setSize(cSize + sizeDelta);
-				c->foodLevel += sizeDelta;
-				cell->setSize(cellSize - sizeDelta);
-			}*/
-			/*
-						double cCurrentSpeed = c->getCurrentSpeed();
-						double cellCurrentSpeed = cell->getCurrentSpeed();
-
-						c->setRotation(c->getRotation() + 180);
-						c->shape.move(cCurrentSpeed * std::sin((PI / 180)*c->getRotation()) * CellSimApp::getInstance().getDeltaTime(), cCurrentSpeed * -std::cos((PI / 180)*c->getRotation()) * CellSimApp::getInstance().getDeltaTime());
-						cell->setRotation(c->getRotation() + 180);
-						cell->shape.move(cellCurrentSpeed * std::sin((PI / 180)*cell->getRotation()) * CellSimApp::getInstance().getDeltaTime(), cellCurrentSpeed * -std::cos((PI / 180)*cell->getRotation()) * CellSimApp::getInstance().getDeltaTime());*/
+	if (c->isDead()) return;
+
+	// contacts are symmetric, so pair is taken from list of cell with lower handle index
+	// freezed cells do not sense - their lists are stale, pairs with them are taken from the other side
+	auto index = c->getHandle().getIndex();
+	for (auto cell : c->CellCollisionVector)
+	{
+		if (cell != c && (cell->isFreezed() || index < cell->getHandle().getIndex()))
+			pairs.emplace_back(c, cell);
+	}
+}
+
+void CellRoles::resolveContactPair(Cell * a, Cell * b)
+{
+	if (a->isDead() || b->isDead()) return;
+
+	RandomStreamScope randomScope(a->randomStream);
+
+	auto aType = a->getGenes().type.get();
+	auto bType = b->getGenes().type.get();
+
+	if (aType != bType && (a->readyToFight || b->readyToFight))
+	{
+		a->delayTime = 0;
+		b->delayTime = 0;
+
+		double sizeWeight = 0.2;
+		double agressionWeight = 0.4;
+		double randomWeight = 0.4;
+
+		auto winner = a;
+		auto loser = b;
+		if (a->getSize() * sizeWeight + a->getGenes().aggresion.get() * agressionWeight + randomInt(1, 20) * randomWeight <=
+			b->getSize() * sizeWeight + b->getGenes().aggresion.get() * agressionWeight + randomInt(1, 20) * randomWeight)
+		{
+			std::swap(winner, loser);
+		}
 
+		loser->setSize(loser->getSize() - 2);
+		if (winner->getFoodLevel() + 2 < winner->getGenes().foodLimit.get())
+		{
+			winner->setFoodLevel(winner->getFoodLevel() + 10);
+		}
+
+		if (loser->getSize() < 5)
+		{
+			loser->kill();
 		}
 	}
+	// horniness is reset by mating - each cell has at most one offspring per step
+	else if (aType == bType && (a->readyToMate || b->readyToMate) && a->horniness.isMax() && b->horniness.isMax())
+	{
+		a->setHorniness(0);
+		a->setFoodLevel(a->getGenes().foodLimit.get() / 2);
+		b->setHorniness(0);
+		b->setFoodLevel(b->getGenes().foodLimit.get() / 2);
+		std::shared_ptr<Cell> tmp = Cell::create(*a, *b);
+		tmp->setAge(0);
+		Environment::getInstance().insertNewCell(tmp);
+	}
 }
 
-void CellRoles::makeOlder(Cell * c)
+void CellRoles::makeOlder(Cell * c, const TickContext& context)
 {
-	if (c->age >= c->genes.maxAge.get())
+	if (c->getAge() >= c->getGenes().maxAge.get())
 	{
 		c->kill();
 		return;
 	}
-	c->age += CellSimApp::getInstance().getDeltaTime()*0.01;
+	c->setAge(c->getAge() + context.deltaTime*0.01);
 }
 
-void CellRoles::mutate(Cell * c)
+void CellRoles::mutate(Cell * c, const TickContext& context)
 {
 	if (randomInt(0, 100) > 99) {
 
 		constexpr double mutationRatio = 100;
 
 		auto& genes = c->getGenes();
-		genes.aggresion = genes.aggresion + genes.aggresion.getRange() / mutationRatio * Environment::getInstance().getRadiation() * randomInt(-1, 1);
-		genes.divisionThreshold = genes.divisionThreshold + genes.divisionThreshold.getRange() / mutationRatio * Environment::getInstance().getRadiation() * randomInt(-1, 1);
-		genes.foodLimit = genes.foodLimit + genes.foodLimit.getRange() / mutationRatio * Environment::getInstance().getRadiation() * randomInt(-1, 1);
-		genes.maxAge = genes.maxAge + genes.maxAge.getRange() / mutationRatio * Environment::getInstance().getRadiation() * randomInt(-1, 1);
-		genes.maxSize = genes.maxSize + genes.maxSize.getRange() / mutationRatio * Environment::getInstance().getRadiation() * randomInt(-1, 1);
-		genes.maxSpeed = genes.maxSpeed + genes.maxSpeed.getRange() / mutationRatio * Environment::getInstance().getRadiation() * randomInt(-1, 1);
-		genes.radarRange = genes.radarRange + genes.radarRange.getRange() / mutationRatio * Environment::getInstance().getRadiation() * randomInt(-1, 1);
-		genes.metabolism = genes.metabolism + genes.metabolism.getRange() / mutationRatio * Environment::getInstance().getRadiation() * randomInt(-1, 1);
+		genes.aggresion = genes.aggresion + genes.aggresion.getRange() / mutationRatio * context.radiation * randomInt(-1, 1);
+		genes.divisionThreshold = genes.divisionThreshold + genes.divisionThreshold.getRange() / mutationRatio * context.radiation * randomInt(-1, 1);
+		genes.foodLimit = genes.foodLimit + genes.foodLimit.getRange() / mutationRatio * context.radiation * randomInt(-1, 1);
+		genes.maxAge = genes.maxAge + genes.maxAge.getRange() / mutationRatio * context.radiation * randomInt(-1, 1);
+		genes.maxSize = genes.maxSize + genes.maxSize.getRange() / mutationRatio * context.radiation * randomInt(-1, 1);
+		genes.maxSpeed = genes.maxSpeed + genes.maxSpeed.getRange() / mutationRatio * context.radiation * randomInt(-1, 1);
+		genes.radarRange = genes.radarRange + genes.radarRange.getRange() / mutationRatio * context.radiation * randomInt(-1, 1);
+		genes.metabolism = genes.metabolism + genes.metabolism.getRange() / mutationRatio * context.radiation * randomInt(-1, 1);
 		c->setFoodLevel(checkRange(c->getFoodLevel(), 0, genes.foodLimit.get()));
-		c->setAge(checkRange(c->age, 0, genes.maxAge.get()));
+		c->setAge(checkRange(c->getAge(), 0, genes.maxAge.get()));
 		c->setSize(checkRange(c->getSize(), 15, genes.maxSize.get()));
 		c->setCurrentSpeed(checkRange(c->getCurrentSpeed(), 0, genes.maxSpeed.get()));
+		c->invalidateColors();
 	}
 
 }
 
-void CellRoles::sniffForFood(Cell * c)
+void CellRoles::sniffForFood(Cell * c, const TickContext& context)
 {
-	if (c->genes.type.get() == 2) return;
+	if (c->getGenes().type.get() == 2) return;
 	c->closestFoodAngle = 0;
-	if (c->foodLevel <= c->genes.foodLimit.get()*0.8 && c->closestFood.first != nullptr && c->closestFood.second <= c->genes.radarRange.get()*c->genes.radarRange.get() + c->getSize())
+	if (c->getFoodLevel() <= c->getGenes().foodLimit.get()*0.8 && c->closestFood.first.isValid() && c->closestFood.second <= c->getGenes().radarRange.get()*c->getGenes().radarRange.get() + c->getSize())
 	{
-		auto v = c->closestFood.first->getPosition() - c->getPosition();
+		auto v = context.getDisplacement(c->getPosition(), c->getClosestFood()->position);
 		float angle = atan2(v.y, v.x);
-		float angle_change = c->genes.turningRate.get() * CellSimApp::getInstance().getDeltaTime();
+		float angle_change = c->getGenes().turningRate.get() * context.deltaTime;
 		angle = angle * (180 / PI);
 		if (angle < 0)
 		{
@@ -560,27 +595,20 @@ void CellRoles::sniffForFood(Cell * c)
 	}
 }
 
-void CellRoles::checkCollisions(Cell * c)
+void CellRoles::checkCollisions(Cell * c, const TickContext& context)
 {
-	c->FoodCollisionVector->clear();
-	c->CellCollisionVector->clear();
-	c->closestFood.first = nullptr;
-	c->closestCell.first = nullptr;
-	c->closestFood.second = -1;
-	c->closestCell.second = -1;
-	c->calcFoodCollisionVector();
-	c->calcCellCollisionVector();
+	c->calcCollisionVectors();
 }
 
-void CellRoles::sniffForCell(Cell * c)
+void CellRoles::sniffForCell(Cell * c, const TickContext& context)
 {
-	if (c->genes.type.get() == 1) return;
+	if (c->getGenes().type.get() == 1) return;
 	c->closestCellAngle = 0;
-	if (c->foodLevel <= c->genes.foodLimit.get()*0.8 && c->closestCell.first != nullptr && c->closestCell.second <= c->genes.radarRange.get()*c->genes.radarRange.get() + c->getSize())
+	if (c->getFoodLevel() <= c->getGenes().foodLimit.get()*0.8 && c->closestCell.first.isValid() && c->closestCell.second <= c->getGenes().radarRange.get()*c->getGenes().radarRange.get() + c->getSize())
 	{
-		auto v = c->closestCell.first->getPosition() - c->getPosition();
+		auto v = context.getDisplacement(c->getPosition(), CellPool::getInstance().get(c->closestCell.first)->getPosition());
 		float angle = atan2(v.y, v.x);
-		float angle_change = c->genes.turningRate.get() * CellSimApp::getInstance().getDeltaTime();
+		float angle_change = c->getGenes().turningRate.get() * context.deltaTime;
 		angle = angle * (180 / PI);
 		if (angle < 0)
 		{
@@ -623,30 +651,33 @@ void CellRoles::sniffForCell(Cell * c)
 	}
 }
 
-bool CellRoles::checkEnvironmentBounds(Cell * c)
+bool CellRoles::checkEnvironmentBounds(Cell * c, const TickContext& context)
 {
-	const auto& envSize = Environment::getInstance().getSize();
-	const auto& cellPos = c->shape.getPosition();
+	// toroidal world has no borders
+	if (context.wrap) return false;
+
+	const auto& envSize = context.envSize;
+	const auto cellPos = c->getPosition();
 
 	// if-else structure for future improvements - return collision bound
 
 	//check left bound
-	if (c->shape.getPosition().x - c->getSize() <= 0)
+	if (cellPos.x - c->getSize() <= 0)
 	{
 		return true;
 	}
 	//check right bound
-	else if (c->shape.getPosition().x + c->getSize() >= envSize.x)
+	else if (cellPos.x + c->getSize() >= envSize.x)
 	{
 		return true;
 	}
 	//check top bound
-	else if (c->shape.getPosition().y - c->getSize() <= 0)
+	else if (cellPos.y - c->getSize() <= 0)
 	{
 		return true;
 	}
 	//check bottom bound
-	else if (c->shape.getPosition().y + c->getSize() >= envSize.y)
+	else if (cellPos.y + c->getSize() >= envSize.y)
 	{
 		return true;
 	}
@@ -654,6 +685,61 @@ bool CellRoles::checkEnvironmentBounds(Cell * c)
 	return false;
 }
 
+CellRoles::BatchRolePtr CellRoles::getBatchRole(RolePtr ptr)
+{
+	if (ptr == moveForward) return moveForwardBatch;
+	return nullptr;
+}
+
+bool CellRoles::isSequentialRole(RolePtr ptr)
+{
+	// eat removes food seen by other cells, divideAndConquer and makeFood insert new objects
+	return ptr == eat || ptr == divideAndConquer || ptr == makeFood;
+}
+
+bool CellRoles::isSenseRole(RolePtr ptr)
+{
+	return ptr == checkCollisions || ptr == sniffForFood || ptr == sniffForCell;
+}
+
+int CellRoles::getArchetypeId(const std::vector<RolePtr>& roles)
+{
+	// only few archetypes exist - linear search
+	for (size_t i = 0; i < archetypes.size(); ++i)
+	{
+		if (archetypes[i].roles == roles)
+			return static_cast<int>(i);
+	}
+
+	Archetype archetype;
+	archetype.roles = roles;
+	for (auto& fn : roles)
+	{
+		if (isSenseRole(fn))
+			archetype.senseRoles.push_back(fn);
+		else
+			archetype.actRoles.push_back(fn);
+	}
+	archetypes.push_back(archetype);
+
+	return static_cast<int>(archetypes.size() - 1);
+}
+
+const std::vector<CellRoles::RolePtr>& CellRoles::getArchetypeSenseRoles(int archetype)
+{
+	return archetypes[archetype].senseRoles;
+}
+
+const std::vector<CellRoles::RolePtr>& CellRoles::getArchetypeActRoles(int archetype)
+{
+	return archetypes[archetype].actRoles;
+}
+
+size_t CellRoles::getArchetypesCount()
+{
+	return archetypes.size();
+}
+
 void CellRoles::registerRole(RolePtr ptr, int id, std::string roleName)
 {
 	roleToId[ptr] = id;
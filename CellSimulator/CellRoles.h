@@ -1,4 +1,5 @@
 #pragma once
+#include <deque>
 #include "Cell.h"
 
 
@@ -10,7 +11,8 @@
 //		and then SEGFAULT or other NullPtrException.
 //		Use Environment::getInstance().addNewCell(..cell..) instead.
 //
-// 2.	For all value changes use deltaTime from CellSimApp.
+// 2.	For all value changes use deltaTime from TickContext (simulation step, not frame time).
+//		Read temperature, radiation and environment size from TickContext too - it is filled once per step.
 //
 // 3.	If you want kill cell use this->kill() [will be moved to dead cells vector],
 //		if you want delete cell from cells vector use this->markAsDeleted() [will be removed from any vector].
@@ -18,11 +20,21 @@
 //
 // 4.	REGISTER ALL NEW ADDED ROLES IN CellRoles C-TOR
 //		This is needed to properly save cell to file.
+//
+// 5.	Sense roles (see isSenseRole) are called for all cells in parallel before other roles.
+//		They can modify only the cell they are called for - other objects are read-only.
+//		Other roles are called in act phase. Those that change objects shared by cells - food store,
+//		new cells, neighbours (see isSequentialRole) - are called sequentially in order of cells
+//		and objects seen in sense phase could be killed or eaten in the meantime - check it before use.
+//		The rest runs in parallel chunks and can modify only the cell it is called for;
+//		kill() is allowed - environment applies killed cells and their food in order after the chunks.
 
 class CellRoles
 {
 public:
-	using RolePtr = void(*)(Cell*);
+	using RolePtr = void(*)(Cell*, const TickContext&);
+	// role-function called once for all cells of archetype - cells with changed archetype have to be skipped
+	using BatchRolePtr = void(*)(Cell* const* cells, size_t count, int archetype, const TickContext& context);
 
 	RolePtr getRoleById(int id);
 
@@ -31,47 +43,113 @@ public:
 	static CellRoles& getManager();
 
 
-	static void moveForward(Cell* c);
+	static void moveForward(Cell* c, const TickContext& context);
+	// moveForward for whole archetype group - movement of all cells is computed in one pass,
+	// cells are reflected by borders or wrapped around them (see Environment::BoundaryMode)
+	static void moveForwardBatch(Cell* const* cells, size_t count, int archetype, const TickContext& context);
+
+	static void changeDirection(Cell* c, const TickContext& context);
+
+	static void changeSpeed(Cell* c, const TickContext& context);
+
+	static void eat(Cell* c, const TickContext& context);
 
-	static void changeDirection(Cell* c);
+	// recomputes colours only if genes changed since last time (see Cell::invalidateColors)
+	static void updateColor(Cell* c, const TickContext& context);
 
-	static void changeSpeed(Cell* c);
+	// body, outline and type shape colours from genes - for cells created or changed outside of step
+	static void refreshColors(Cell* c);
 
-	static void eat(Cell* c);
+	static void beDead(Cell* c, const TickContext& context);
 
-	static void updateColor(Cell* c);
+	static void simulateHunger(Cell* c, const TickContext& context);
 
-	static void beDead(Cell* c);
+	static void divideAndConquer(Cell* c, const TickContext& context);
 
-	static void simulateHunger(Cell * c);
+	static void grow(Cell* c, const TickContext& context);
 
-	static void divideAndConquer(Cell * c);
+	static void getingHot(Cell* c, const TickContext& context);
 
-	static void grow(Cell * c);
+	static void makeFood(Cell* c, const TickContext& context);
 
-	static void getingHot(Cell * c);
+	static void fight(Cell* c, const TickContext& context);
 
-	static void makeFood(Cell * c);
+	static void makeOlder(Cell* c, const TickContext& context);
 
-	static void fight(Cell * c);
+	static void mutate(Cell* c, const TickContext& context);
 
-	static void makeOlder(Cell * c);
+	static void sniffForFood(Cell* c, const TickContext& context);
 
-	static void mutate(Cell * c);
+	static void checkCollisions(Cell* c, const TickContext& context);
 
-	static void sniffForFood(Cell * c);
+	static void sniffForCell(Cell* c, const TickContext& context);
 
-	static void checkCollisions(Cell * c);
+	// Fight and mating are resolved once per unordered pair of cells in contact.
+	// fight and getingHot roles only mark cells ready for them.
 
-	static void sniffForCell(Cell * c);
+	// appends pairs of c with its contacts from sense phase (each pair is appended by one of its cells),
+	// clears marks of previous step - called for cells in order of cells vector before act phase
+	static void collectContactPairs(Cell* c, std::vector<std::pair<Cell*, Cell*>>& pairs);
+
+	// fight of cells of different types (if any of them is ready) or mating of cells of the same type
+	// (if both are horny) - called after act phase, uses random stream of a
+	static void resolveContactPair(Cell* a, Cell* b);
 
 	/// \returns true if collision occured - otherwise false
-	static bool checkEnvironmentBounds(Cell* c);
+	static bool checkEnvironmentBounds(Cell* c, const TickContext& context);
+
+	/// \returns true for role-functions called in sense phase
+	static bool isSenseRole(RolePtr ptr);
+
+	/// \returns true for act role-functions that change objects shared by cells (food, new cells) -
+	/// environment calls them sequentially, other act roles run in parallel
+	static bool isSequentialRole(RolePtr ptr);
+
+	/// \returns batch version of role-function used by environment, nullptr if there is none
+	static BatchRolePtr getBatchRole(RolePtr ptr);
+
+	// Archetype - set of role-functions shared by many cells (default, lettuce/pizza makers, dead...).
+	// Environment groups cells by archetype and calls every role-function in one loop over the group.
+	// Archetypes are registered at first use and never removed, ids are not saved to file.
+
+	/// \returns id of archetype with given role-functions (in this order)
+	int getArchetypeId(const std::vector<RolePtr>& roles);
+
+	const std::vector<RolePtr>& getArchetypeSenseRoles(int archetype);
+	const std::vector<RolePtr>& getArchetypeActRoles(int archetype);
+
+	size_t getArchetypesCount();
 private:
 	CellRoles();
 	inline void registerRole(RolePtr ptr, int id, std::string roleName = "");
 
+
+	struct Archetype
+	{
+		std::vector<RolePtr> roles;
+		std::vector<RolePtr> senseRoles;
+		std::vector<RolePtr> actRoles;
+	};
+
+	// deque - references to archetypes stay valid when new one is registered during act phase
+	std::deque<Archetype> archetypes;
+
 	std::map<int, RolePtr> idToRole;
 	std::map<RolePtr, int> roleToId;
+
+	// state of cells packed by moveForwardBatch - every thread reuses its own buffers
+	struct MoveBuffers
+	{
+		std::vector<float> x;
+		std::vector<float> y;
+		std::vector<float> radius;
+		std::vector<double> speed;
+		std::vector<double> headingX;
+		std::vector<double> headingY;
+		// bit 0 - heading x mirrored by border, bit 1 - heading y
+		std::vector<uint8_t> mirrored;
+
+		void resize(size_t count);
+	};
 };
 
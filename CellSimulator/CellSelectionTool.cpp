@@ -79,9 +79,9 @@ void CellSelectionTool::updateSelectionMarker()
 		auto closestFood = selectedCell->getClosestFood();
 		if (closestFood != nullptr)
 		{
-			targetFoodSelectionMarker.setRadius(closestFood->getSize() + 20);
-			targetFoodSelectionMarker.setOrigin(closestFood->getSize() + 20, closestFood->getSize() + 20);
-			targetFoodSelectionMarker.setPosition(closestFood->getPosition());
+			targetFoodSelectionMarker.setRadius(closestFood->size + 20);
+			targetFoodSelectionMarker.setOrigin(closestFood->size + 20, closestFood->size + 20);
+			targetFoodSelectionMarker.setPosition(closestFood->position);
 		}
 
 		auto radarRadius = selectedCell->getGenes().radarRange.get();
@@ -10,9 +10,13 @@
 #include "MessagesManager.h"
 #include "CellInsertionTool.h"
 #include "FoodBrush.h"
+#include "CellMovementTool.h"
 #include "CellFactory.h"
 #include "ToolManager.h"
+#include "AutoFeederTool.h"
 #include "SaveManager.h"
+#include "SimulationClock.h"
+#include "DoubleToString.h"
 #include <iostream>
 #include <atomic>
 
@@ -35,12 +39,19 @@ CellSimApp::~CellSimApp()
 void CellSimApp::run()
 {
 	MessagesManager::getInstance().configure();
+	SimulationClock::getInstance().configure();
+	// drawing and user tools are attached to environment only by this app
+	auto background = TextureProvider::getInstance().getTexture("background2");
+	background->setSmooth(false);
+	Environment::getInstance().setBackgroundTexture(background.get());
+	Environment::getInstance().setStepHook([]() { AutoFeederTool::getInstance().update(); });
 	Environment::getInstance().configure({ 3000,1500 }, true);
 	GUIManager::getInstance().configure(window);
 	ToolManager::getInstance().enable();
 	ToolManager::getInstance().setActiveTool(ToolManager::Tool::SelectionMovement);
 
 	view.setCenter(sf::Vector2f(Environment::getInstance().getSize().x / 2, Environment::getInstance().getSize().y / 2));
+	environmentSize = Environment::getInstance().getSize();
 
 	sf::Event event;
 	sf::Clock deltaTimeClock;
@@ -167,6 +178,18 @@ void CellSimApp::run()
 				zoomByOneStep = !zoomByOneStep;
 			}
 
+			if (event.type == sf::Event::KeyPressed && (event.key.code == sf::Keyboard::Multiply || event.key.code == sf::Keyboard::Divide))
+			{
+				auto scale = SimulationClock::getInstance().getTimeScale();
+				if (event.key.code == sf::Keyboard::Multiply && scale < 8)
+					scale *= 2;
+				if (event.key.code == sf::Keyboard::Divide && scale > 0.25)
+					scale /= 2;
+
+				SimulationClock::getInstance().setTimeScale(scale);
+				MessagesManager::getInstance().append("Simulation speed: x" + doubleToString(scale, 2) + ".");
+			}
+
 			//if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::PageUp)
 			//	FoodBrush::getInstance().setBrushRadius(FoodBrush::getInstance().getBrushRadius() + 2);
 			//if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::PageDown)
@@ -181,12 +204,31 @@ void CellSimApp::run()
 		updateViewCenter();
 		updateViewZoom();
 
-		Environment::getInstance().update();
+		CellMovementTool::getInstance().update();
+		CellSelectionTool::getInstance().update();
+		CellInsertionTool::getInstance().update();
+
+		// simulate whole fixed steps covered by last frame duration
+		auto& simulationClock = SimulationClock::getInstance();
+		int steps = simulationClock.advance(deltaTime);
+		for (int i = 0; i < steps; ++i)
+		{
+			Environment::getInstance().update(simulationClock.getTickSize());
+		}
+
+		// brush uses simulated time of this frame - known after advance
+		FoodBrush::getInstance().update();
+
+		CellSelectionTool::getInstance().updateSelectionMarker();
 
 		//DRAW --->
 		window->clear();
 
 		Environment::getInstance().draw(*window);
+		CellSelectionTool::getInstance().draw(*window);
+		CellMovementTool::getInstance().draw(*window);
+		CellInsertionTool::getInstance().draw(*window);
+		FoodBrush::getInstance().draw(*window);
 		GUIManager::getInstance().draw();
 
 		window->display();
@@ -227,9 +269,6 @@ void CellSimApp::configure()
 
 	Logger::log(windowTitle + " - build " + __DATE__ + " " + __TIME__);
 
-	// first getInstance call loads all textures
-	TextureProvider::getInstance();
-
 #ifdef DEBUG 
 	window->create(windowVideoMode, windowTitle, sf::Style::Close);
 #else 
@@ -342,6 +381,13 @@ void CellSimApp::updateViewZoom()
 
 void CellSimApp::updateViewCenter()
 {
+	// environment was reconfigured (new, loaded or resized) - look at its center
+	if (environmentSize != Environment::getInstance().getSize())
+	{
+		environmentSize = Environment::getInstance().getSize();
+		view.setCenter(environmentSize / 2.0f);
+	}
+
 	if (CellSelectionTool::getInstance().getFollowSelectedCell())
 	{
 		auto cell = CellSelectionTool::getInstance().getSelectedCell();
@@ -37,6 +37,9 @@ private:
 	sf::View view;
 	sf::VideoMode windowVideoMode;
 
+	// used to detect environment reconfiguration
+	sf::Vector2f environmentSize;
+
 	sf::Font font;
 
 	std::string windowTitle;
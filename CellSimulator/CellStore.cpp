@@ -0,0 +1,199 @@
+#include "CellStore.h"
+#include <algorithm>
+#include <functional>
+
+CellStore::Row::Row()
+{
+	index = CellStore::getInstance().addRow(this);
+}
+
+CellStore::Row::Row(const Row & other)
+{
+	index = CellStore::getInstance().addRow(this, other.index);
+}
+
+CellStore::Row::Row(Row && other)
+{
+	// take over row of temporary cell
+	index = other.index;
+	other.index = noIndex;
+	if (index != noIndex)
+		CellStore::getInstance().handles[index] = this;
+}
+
+CellStore::Row & CellStore::Row::operator=(const Row & other)
+{
+	if (this != &other)
+		CellStore::getInstance().copyRow(other.index, index);
+	return *this;
+}
+
+CellStore::Row::~Row()
+{
+	if (index != noIndex && !destroyed)
+		CellStore::getInstance().releaseRow(index);
+}
+
+bool CellStore::destroyed = false;
+
+CellStore::CellStore()
+{
+}
+
+CellStore::~CellStore()
+{
+	destroyed = true;
+}
+
+CellStore & CellStore::getInstance()
+{
+	static CellStore instance;
+	return instance;
+}
+
+void CellStore::compact()
+{
+	// from the highest row - last row is always alive or just released one
+	std::sort(releasedRows.begin(), releasedRows.end(), std::greater<size_t>());
+	for (auto row : releasedRows)
+	{
+		auto last = handles.size() - 1;
+		if (row != last)
+		{
+			copyRow(last, row);
+			handles[row] = handles[last];
+			handles[row]->index = row;
+		}
+		popRow();
+	}
+	releasedRows.clear();
+}
+
+namespace
+{
+	template <typename T>
+	void permuteColumn(std::vector<T>& column, const std::vector<size_t>& order)
+	{
+		std::vector<T> permuted;
+		permuted.reserve(column.size());
+		for (auto row : order)
+			permuted.push_back(std::move(column[row]));
+		column.swap(permuted);
+	}
+}
+
+void CellStore::reorder(const std::vector<size_t>& firstRows)
+{
+	auto count = handles.size();
+	std::vector<size_t> order;
+	order.reserve(count);
+	std::vector<bool> listed(count, false);
+	for (auto row : firstRows)
+	{
+		if (row < count && !listed[row])
+		{
+			listed[row] = true;
+			order.push_back(row);
+		}
+	}
+	for (size_t row = 0; row < count; ++row)
+	{
+		if (!listed[row]) order.push_back(row);
+	}
+
+	permuteColumn(positionX, order);
+	permuteColumn(positionY, order);
+	permuteColumn(rotation, order);
+	permuteColumn(headingX, order);
+	permuteColumn(headingY, order);
+	permuteColumn(radius, order);
+	permuteColumn(speed, order);
+	permuteColumn(foodLevel, order);
+	permuteColumn(age, order);
+	permuteColumn(genes, order);
+	permuteColumn(handles, order);
+
+	// released rows have no handle - they are found by compact() through releasedRows
+	std::vector<size_t> newIndex(count);
+	for (size_t row = 0; row < count; ++row)
+	{
+		newIndex[order[row]] = row;
+		if (handles[row] != nullptr) handles[row]->index = row;
+	}
+	for (auto& row : releasedRows)
+		row = newIndex[row];
+}
+
+size_t CellStore::getRowsCount()
+{
+	return handles.size();
+}
+
+size_t CellStore::addRow(Row * handle)
+{
+	positionX.push_back(0);
+	positionY.push_back(0);
+	rotation.push_back(0);
+	headingX.push_back(0);
+	headingY.push_back(-1);
+	radius.push_back(0);
+	speed.push_back(0);
+	foodLevel.push_back(0);
+	age.push_back(0);
+	genes.emplace_back();
+	handles.push_back(handle);
+
+	return handles.size() - 1;
+}
+
+size_t CellStore::addRow(Row * handle, size_t copyFrom)
+{
+	positionX.push_back(positionX[copyFrom]);
+	positionY.push_back(positionY[copyFrom]);
+	rotation.push_back(rotation[copyFrom]);
+	headingX.push_back(headingX[copyFrom]);
+	headingY.push_back(headingY[copyFrom]);
+	radius.push_back(radius[copyFrom]);
+	speed.push_back(speed[copyFrom]);
+	foodLevel.push_back(foodLevel[copyFrom]);
+	age.push_back(age[copyFrom]);
+	genes.push_back(Genes(genes[copyFrom]));
+	handles.push_back(handle);
+
+	return handles.size() - 1;
+}
+
+void CellStore::copyRow(size_t from, size_t to)
+{
+	positionX[to] = positionX[from];
+	positionY[to] = positionY[from];
+	rotation[to] = rotation[from];
+	headingX[to] = headingX[from];
+	headingY[to] = headingY[from];
+	radius[to] = radius[from];
+	speed[to] = speed[from];
+	foodLevel[to] = foodLevel[from];
+	age[to] = age[from];
+	genes[to] = genes[from];
+}
+
+void CellStore::popRow()
+{
+	positionX.pop_back();
+	positionY.pop_back();
+	rotation.pop_back();
+	headingX.pop_back();
+	headingY.pop_back();
+	radius.pop_back();
+	speed.pop_back();
+	foodLevel.pop_back();
+	age.pop_back();
+	genes.pop_back();
+	handles.pop_back();
+}
+
+void CellStore::releaseRow(size_t row)
+{
+	handles[row] = nullptr;
+	releasedRows.push_back(row);
+}
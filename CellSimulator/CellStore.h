@@ -0,0 +1,78 @@
+#pragma once
+#include <vector>
+#include "Genes.h"
+
+// Columnar storage of cell state.
+// Every Cell owns one row (CellStore::Row) - values of all cells are kept in contiguous arrays,
+// so loops over cells read memory linearly instead of chasing pointers through Cell objects.
+//
+// Rows of destroyed cells are released and removed in compact() - it has to be called
+// when nothing iterates over the store (start of environment update).
+// Not locked - rows are added and released on main thread only (cells are created and destroyed
+// outside of parallel sense phase), worker threads only read and write values of existing rows.
+class CellStore final
+{
+public:
+	// handle of single row - copied together with cell (copy gets new row with the same values)
+	class Row final
+	{
+	public:
+		Row();
+		Row(const Row& other);
+		Row(Row&& other);
+		Row& operator=(const Row& other);
+		~Row();
+
+		size_t get() const { return index; }
+
+	private:
+		friend class CellStore;
+		static constexpr size_t noIndex = static_cast<size_t>(-1);
+
+		size_t index;
+	};
+
+	~CellStore();
+	static CellStore& getInstance();
+
+	// removes rows released by destroyed cells - swaps last rows into their place
+	void compact();
+
+	// moves given rows to the front in given order, other rows follow in current order
+	// (cells iterated in order of their rows read columns linearly)
+	void reorder(const std::vector<size_t>& firstRows);
+
+	// released rows are included until next compact
+	size_t getRowsCount();
+
+	// columns - indexed by Row::get()
+	std::vector<float> positionX;
+	std::vector<float> positionY;
+	std::vector<float> rotation;
+	// unit vector of rotation (sin, -cos) - set together with rotation, so movement needs no trigonometry
+	std::vector<double> headingX;
+	std::vector<double> headingY;
+	std::vector<float> radius;
+	std::vector<double> speed;
+	std::vector<double> foodLevel;
+	std::vector<double> age;
+	std::vector<Genes> genes;
+
+private:
+	CellStore();
+	CellStore(const CellStore&) = delete;
+	CellStore& operator=(const CellStore&) = delete;
+
+	size_t addRow(Row* handle);
+	size_t addRow(Row* handle, size_t copyFrom);
+	void copyRow(size_t from, size_t to);
+	void popRow();
+	void releaseRow(size_t row);
+
+	std::vector<Row*> handles;
+
+	// store can be destroyed at exit before singletons that still keep cells
+	static bool destroyed;
+
+	std::vector<size_t> releasedRows;
+};
@@ -0,0 +1,665 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include "PackedScan.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Flat uniform grid of collision sectors (cell list).
+// Built from scratch with counting sort over object indices - every sector is a contiguous
+// range of indices into the vector the grid was built from, so lookups do not copy shared_ptrs
+// and moving objects between sectors costs nothing until the next rebuild.
+//
+// Indices are valid as long as the source container is not modified (until end of simulation step).
+// Positions and radii from rebuild are also kept packed in sector order for vectorized scans (see PackedScan).
+// Occupancy bitmaps (per row and per column) and summed-area table of sector counts let searches skip
+// empty sectors and whole empty rings without touching their ranges.
+
+// Result of CollisionGrid::findNearest - kept by caller and reused between queries.
+struct NearestQuery
+{
+	// k nearest objects in range - index and squared distance, nearest first (lower index first if distances are equal)
+	std::vector<std::pair<uint32_t, double>> nearest;
+	// all objects in contact, by index
+	std::vector<uint32_t> contacts;
+};
+
+// State of one nearest/contact search - fills NearestQuery with objects passed to visit().
+// distance(i) - squared distance to i-th object, negative to skip the object
+// inContact(i, distance) - true if i-th object touches searching one (only objects closer than contactRange
+// are checked, so contactRange must not be less than the largest contact distance)
+template <typename DistanceFunction, typename ContactFunction>
+class NearestSearch final
+{
+public:
+	NearestSearch(double range, double contactRange, size_t k, DistanceFunction distance, ContactFunction inContact, NearestQuery& result)
+		: rangeSquared(range * range), contactRangeSquared(contactRange * contactRange), k(k),
+		distance(distance), inContact(inContact), result(result)
+	{
+		result.nearest.clear();
+		result.contacts.clear();
+	}
+
+	void visit(uint32_t index)
+	{
+		auto d = distance(index);
+		if (d < 0) return;
+
+		// ties are resolved by index - result does not depend on order of visiting
+		auto closer = [](double d, uint32_t index, const std::pair<uint32_t, double>& n) {
+			return d < n.second || (d == n.second && index < n.first);
+		};
+
+		if (d < rangeSquared && k > 0 && (result.nearest.size() < k || closer(d, index, result.nearest.back())))
+		{
+			auto it = std::upper_bound(result.nearest.begin(), result.nearest.end(), d,
+				[&](double value, const std::pair<uint32_t, double>& n) { return closer(value, index, n); });
+			result.nearest.insert(it, std::make_pair(index, d));
+			if (result.nearest.size() > k) result.nearest.pop_back();
+		}
+
+		if (d <= contactRangeSquared && inContact(index, d))
+			result.contacts.push_back(index);
+	}
+
+	template <typename Grid>
+	void visitSector(const Grid& grid, int x, int y)
+	{
+		for (auto index : grid.getSector(x, y))
+			visit(index);
+	}
+
+	// called after last visited sector - search can be continued from other position (copy of position
+	// across borders of toroidal world), objects found again are not repeated
+	void finish()
+	{
+		std::sort(result.contacts.begin(), result.contacts.end());
+		result.contacts.erase(std::unique(result.contacts.begin(), result.contacts.end()), result.contacts.end());
+	}
+
+	// squared distance - objects farther than it cannot change result
+	double getLimit() const
+	{
+		// k = 0 - contacts only
+		if (k == 0) return contactRangeSquared;
+		return std::max(contactRangeSquared, result.nearest.size() == k ? result.nearest.back().second : rangeSquared);
+	}
+
+private:
+	double rangeSquared;
+	double contactRangeSquared;
+	size_t k;
+	DistanceFunction distance;
+	ContactFunction inContact;
+	NearestQuery& result;
+};
+
+// Search over packed positions and radii of grid (scanPacked) - at most one nearest object.
+// Distance is measured between centers, object is in contact if distance <= radius + object radius + margin.
+// Skips nothing - use NearestSearch if some objects have to be ignored.
+class PackedNearestSearch final
+{
+public:
+	PackedNearestSearch(const sf::Vector2f& position, double range, bool findNearest, float radius, float margin, double contactRange, bool findContacts, NearestQuery& result)
+		: position(position), rangeSquared(range * range), findNearest(findNearest), radius(radius), margin(margin),
+		contactRangeSquared(contactRange * contactRange), findContacts(findContacts), result(result)
+	{
+		result.nearest.clear();
+		result.contacts.clear();
+	}
+
+	template <typename Grid>
+	void visitSector(const Grid& grid, int x, int y)
+	{
+		auto sector = grid.getPackedSector(x, y);
+		if (sector.size == 0) return;
+
+		// positions in sector are written after found contacts and replaced by object indices
+		auto first = result.contacts.size();
+		if (findContacts) result.contacts.resize(first + sector.size);
+
+		auto scan = scanPacked(sector.x, sector.y, sector.radius, sector.size, position.x, position.y, radius, margin,
+			findContacts ? result.contacts.data() + first : nullptr);
+
+		if (findContacts)
+		{
+			for (size_t i = 0; i < scan.contactsCount; ++i)
+				result.contacts[first + i] = sector.indices[result.contacts[first + i]];
+			result.contacts.resize(first + scan.contactsCount);
+		}
+
+		// first of equal distances in sector has the lowest index - indices are sorted inside sectors
+		if (findNearest && scan.nearest >= 0)
+		{
+			double distance = scan.nearestDistance;
+			auto index = sector.indices[scan.nearest];
+			if (distance < rangeSquared && (result.nearest.empty() || distance < result.nearest.back().second ||
+				(distance == result.nearest.back().second && index < result.nearest.back().first)))
+				result.nearest.assign(1, std::make_pair(index, distance));
+		}
+	}
+
+	void finish()
+	{
+		std::sort(result.contacts.begin(), result.contacts.end());
+		result.contacts.erase(std::unique(result.contacts.begin(), result.contacts.end()), result.contacts.end());
+	}
+
+	// search continued from other position - see NearestSearch::finish
+	void setPosition(const sf::Vector2f& position)
+	{
+		this->position = position;
+	}
+
+	double getLimit() const
+	{
+		double nearestLimit = 0;
+		if (findNearest) nearestLimit = result.nearest.empty() ? rangeSquared : result.nearest.back().second;
+		return std::max(findContacts ? contactRangeSquared : 0, nearestLimit);
+	}
+
+private:
+	sf::Vector2f position;
+	double rangeSquared;
+	bool findNearest;
+	float radius;
+	float margin;
+	double contactRangeSquared;
+	bool findContacts;
+	NearestQuery& result;
+};
+
+template <typename DistanceFunction, typename ContactFunction>
+inline NearestSearch<DistanceFunction, ContactFunction> makeNearestSearch(double range, double contactRange, size_t k,
+	DistanceFunction distance, ContactFunction inContact, NearestQuery& result)
+{
+	return NearestSearch<DistanceFunction, ContactFunction>(range, contactRange, k, distance, inContact, result);
+}
+
+template <typename T>
+class CollisionGrid final
+{
+public:
+	// contiguous range of indices in one sector
+	class Range final
+	{
+	public:
+		Range(const uint32_t* first, const uint32_t* last) : first(first), last(last) {}
+
+		const uint32_t* begin() const { return first; }
+		const uint32_t* end() const { return last; }
+		size_t size() const { return last - first; }
+		bool empty() const { return first == last; }
+
+	private:
+		const uint32_t* first;
+		const uint32_t* last;
+	};
+
+	CollisionGrid();
+
+	void configure(sf::Vector2f areaSize, float sectorSize);
+	void clear();
+
+	// sorts objects into sectors - O(objects + sectors)
+	void rebuild(const std::vector<std::shared_ptr<T>>& objects);
+
+	// position(i) / radius(i) return position / radius of i-th object of source container
+	template <typename PositionFunction, typename RadiusFunction>
+	void rebuild(size_t count, PositionFunction position, RadiusFunction radius);
+
+	// Searches sectors in square rings of growing distance from position - stops when the whole next ring
+	// is farther than search limit (contact range or k-th nearest object found so far, see NearestSearch).
+	template <typename Search>
+	void findNearest(const sf::Vector2f& position, Search& search) const;
+
+	// Fused search in this grid and other grid with the same geometry (e.g. cells and food) -
+	// every ring bound is computed once and every sector is visited once for both grids.
+	template <typename U, typename Search, typename OtherSearch>
+	void findNearest(const sf::Vector2f& position, Search& search, const CollisionGrid<U>& other, OtherSearch& otherSearch) const;
+
+	Range getSector(int x, int y) const;
+
+	// objects of one sector - indices with packed positions and radii from last rebuild
+	struct PackedSector
+	{
+		const uint32_t* indices;
+		const float* x;
+		const float* y;
+		const float* radius;
+		size_t size;
+	};
+
+	PackedSector getPackedSector(int x, int y) const;
+
+	sf::Vector2i getSectorsCount() const;
+
+	// positions outside of grid are clamped to border sectors
+	sf::Vector2i getSectorCoords(const sf::Vector2f& position) const;
+
+	// radius of the largest object from last rebuild
+	float getMaxRadius() const;
+
+	// number of objects in sectors x0..x1, y0..y1 (inclusive, clamped to grid) - O(1)
+	size_t countInSectors(int x0, int y0, int x1, int y1) const;
+
+	// number of objects in sectors touching square of half-side range around position - O(1),
+	// 0 means there is nothing within range (e.g. "any food nearby?")
+	size_t countInRange(const sf::Vector2f& position, double range) const;
+
+	// bit i set - sector (64 * word + i, y) / (x, 64 * word + i) is not empty
+	uint64_t getRowOccupancy(int y, int word) const;
+	uint64_t getColumnOccupancy(int x, int word) const;
+
+private:
+	// inclusive range of sectors, empty if x0 > x1 or y0 > y1
+	struct SectorBlock
+	{
+		int x0, y0, x1, y1;
+	};
+
+	SectorBlock getSectorsInRange(const sf::Vector2f& position, double range) const;
+
+	template <typename Occupancy>
+	static size_t countInBlock(const Occupancy& occupancy, const SectorBlock& block);
+
+	static int lowestSetBit(uint64_t bits);
+
+	// calls visitSector(x, y) for not empty sectors (by occupancy - this grid or union of grids) in rings
+	// around position until limit() (squared distance) is less than distance to the next ring
+	// or there are no more objects within limit
+	template <typename Occupancy, typename SectorVisitor, typename LimitFunction>
+	void visitRings(const sf::Vector2f& position, const Occupancy& occupancy, SectorVisitor visitSector, LimitFunction limit) const;
+
+	// calls visitSector(x, y) for not empty sectors of ring r around center inside grid (ring 0 - center sector)
+	template <typename Occupancy, typename SectorVisitor>
+	void visitRing(sf::Vector2i center, int r, const Occupancy& occupancy, SectorVisitor visitSector) const;
+
+	float sectorSize;
+	float maxRadius;
+	int sectorsX;
+	int sectorsY;
+
+	// sectorStarts[s] .. sectorStarts[s + 1] - range of sector s in indices
+	std::vector<uint32_t> sectorStarts;
+	std::vector<uint32_t> indices;
+
+	// sector, position and radius of every object - filled in first pass of rebuild
+	std::vector<uint32_t> objectSectors;
+	std::vector<sf::Vector2f> objectPositions;
+	std::vector<float> objectRadii;
+
+	// parallel to indices
+	std::vector<float> packedX;
+	std::vector<float> packedY;
+	std::vector<float> packedRadii;
+
+	// sectorCountsSum[(x + 1) * (sectorsY + 1) + y + 1] - number of objects in sectors 0..x, 0..y
+	std::vector<uint32_t> sectorCountsSum;
+
+	// rowWords words per row / columnWords words per column, see getRowOccupancy
+	int rowWords;
+	int columnWords;
+	std::vector<uint64_t> rowOccupancy;
+	std::vector<uint64_t> columnOccupancy;
+};
+
+// Occupancy of two grids with the same geometry - used by fused search to skip sectors empty in both.
+template <typename A, typename B>
+class OccupancyUnion final
+{
+public:
+	OccupancyUnion(const A& first, const B& second) : first(first), second(second) {}
+
+	size_t countInSectors(int x0, int y0, int x1, int y1) const
+	{
+		return first.countInSectors(x0, y0, x1, y1) + second.countInSectors(x0, y0, x1, y1);
+	}
+
+	uint64_t getRowOccupancy(int y, int word) const
+	{
+		return first.getRowOccupancy(y, word) | second.getRowOccupancy(y, word);
+	}
+
+	uint64_t getColumnOccupancy(int x, int word) const
+	{
+		return first.getColumnOccupancy(x, word) | second.getColumnOccupancy(x, word);
+	}
+
+private:
+	const A& first;
+	const B& second;
+};
+
+template<typename T>
+inline CollisionGrid<T>::CollisionGrid() : sectorSize(1), maxRadius(0), sectorsX(0), sectorsY(0), rowWords(0), columnWords(0)
+{
+}
+
+template<typename T>
+inline void CollisionGrid<T>::configure(sf::Vector2f areaSize, float sectorSize)
+{
+	this->sectorSize = sectorSize;
+	sectorsX = static_cast<int>(areaSize.x / sectorSize) + 1;
+	sectorsY = static_cast<int>(areaSize.y / sectorSize) + 1;
+	rowWords = (sectorsX + 63) / 64;
+	columnWords = (sectorsY + 63) / 64;
+	clear();
+}
+
+template<typename T>
+inline void CollisionGrid<T>::clear()
+{
+	sectorStarts.assign(static_cast<size_t>(sectorsX) * sectorsY + 1, 0);
+	indices.clear();
+	objectSectors.clear();
+	objectPositions.clear();
+	objectRadii.clear();
+	packedX.clear();
+	packedY.clear();
+	packedRadii.clear();
+	sectorCountsSum.assign(static_cast<size_t>(sectorsX + 1) * (sectorsY + 1), 0);
+	rowOccupancy.assign(static_cast<size_t>(sectorsY) * rowWords, 0);
+	columnOccupancy.assign(static_cast<size_t>(sectorsX) * columnWords, 0);
+	maxRadius = 0;
+}
+
+template<typename T>
+inline void CollisionGrid<T>::rebuild(const std::vector<std::shared_ptr<T>>& objects)
+{
+	rebuild(objects.size(),
+		[&objects](size_t i) { return objects[i]->getPosition(); },
+		[&objects](size_t i) { return objects[i]->getSize(); });
+}
+
+template<typename T>
+template<typename PositionFunction, typename RadiusFunction>
+inline void CollisionGrid<T>::rebuild(size_t count, PositionFunction position, RadiusFunction radius)
+{
+	std::fill(sectorStarts.begin(), sectorStarts.end(), 0);
+	objectSectors.resize(count);
+	objectPositions.resize(count);
+	objectRadii.resize(count);
+	indices.resize(count);
+	packedX.resize(count);
+	packedY.resize(count);
+	packedRadii.resize(count);
+	maxRadius = 0;
+
+	// count objects in every sector (shifted by one - prefix sum gives range begins)
+	for (size_t i = 0; i < count; ++i)
+	{
+		objectPositions[i] = position(i);
+		objectRadii[i] = static_cast<float>(radius(i));
+
+		auto coords = getSectorCoords(objectPositions[i]);
+		auto sector = static_cast<uint32_t>(coords.x * sectorsY + coords.y);
+		objectSectors[i] = sector;
+		++sectorStarts[sector + 1];
+		maxRadius = std::max(maxRadius, objectRadii[i]);
+	}
+
+	// summed-area table and occupancy bits from counts
+	std::fill(rowOccupancy.begin(), rowOccupancy.end(), 0);
+	std::fill(columnOccupancy.begin(), columnOccupancy.end(), 0);
+	const size_t sumStride = sectorsY + 1;
+	for (int x = 0; x < sectorsX; ++x)
+	{
+		uint32_t columnSum = 0;
+		for (int y = 0; y < sectorsY; ++y)
+		{
+			auto count = sectorStarts[static_cast<size_t>(x) * sectorsY + y + 1];
+			columnSum += count;
+			sectorCountsSum[(x + 1) * sumStride + y + 1] = sectorCountsSum[x * sumStride + y + 1] + columnSum;
+
+			if (count > 0)
+			{
+				rowOccupancy[static_cast<size_t>(y) * rowWords + x / 64] |= uint64_t(1) << (x % 64);
+				columnOccupancy[static_cast<size_t>(x) * columnWords + y / 64] |= uint64_t(1) << (y % 64);
+			}
+		}
+	}
+
+	for (size_t s = 1; s < sectorStarts.size(); ++s)
+		sectorStarts[s] += sectorStarts[s - 1];
+
+	// stable - objects keep order of source vector inside sector
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto slot = sectorStarts[objectSectors[i]]++;
+		indices[slot] = static_cast<uint32_t>(i);
+		packedX[slot] = objectPositions[i].x;
+		packedY[slot] = objectPositions[i].y;
+		packedRadii[slot] = objectRadii[i];
+	}
+
+	// every begin was moved to the end of its sector - shift back
+	for (size_t s = sectorStarts.size() - 1; s > 0; --s)
+		sectorStarts[s] = sectorStarts[s - 1];
+	sectorStarts[0] = 0;
+}
+
+template<typename T>
+template<typename Search>
+inline void CollisionGrid<T>::findNearest(const sf::Vector2f & position, Search & search) const
+{
+	visitRings(position, *this,
+		[&](int x, int y) {
+			search.visitSector(*this, x, y);
+		},
+		[&]() { return search.getLimit(); });
+	search.finish();
+}
+
+template<typename T>
+template<typename U, typename Search, typename OtherSearch>
+inline void CollisionGrid<T>::findNearest(const sf::Vector2f & position, Search & search, const CollisionGrid<U>& other, OtherSearch & otherSearch) const
+{
+	visitRings(position, OccupancyUnion<CollisionGrid<T>, CollisionGrid<U>>(*this, other),
+		[&](int x, int y) {
+			search.visitSector(*this, x, y);
+			otherSearch.visitSector(other, x, y);
+		},
+		[&]() { return std::max(search.getLimit(), otherSearch.getLimit()); });
+	search.finish();
+	otherSearch.finish();
+}
+
+template<typename T>
+inline typename CollisionGrid<T>::Range CollisionGrid<T>::getSector(int x, int y) const
+{
+	auto sector = static_cast<size_t>(x) * sectorsY + y;
+	return Range(indices.data() + sectorStarts[sector], indices.data() + sectorStarts[sector + 1]);
+}
+
+template<typename T>
+inline typename CollisionGrid<T>::PackedSector CollisionGrid<T>::getPackedSector(int x, int y) const
+{
+	auto sector = static_cast<size_t>(x) * sectorsY + y;
+	auto first = sectorStarts[sector];
+	return PackedSector{ indices.data() + first, packedX.data() + first, packedY.data() + first, packedRadii.data() + first,
+		static_cast<size_t>(sectorStarts[sector + 1] - first) };
+}
+
+template<typename T>
+inline sf::Vector2i CollisionGrid<T>::getSectorsCount() const
+{
+	return sf::Vector2i(sectorsX, sectorsY);
+}
+
+template<typename T>
+inline sf::Vector2i CollisionGrid<T>::getSectorCoords(const sf::Vector2f & position) const
+{
+	int x = static_cast<int>(position.x / sectorSize);
+	int y = static_cast<int>(position.y / sectorSize);
+	return sf::Vector2i(std::min(std::max(x, 0), sectorsX - 1), std::min(std::max(y, 0), sectorsY - 1));
+}
+
+template<typename T>
+inline float CollisionGrid<T>::getMaxRadius() const
+{
+	return maxRadius;
+}
+
+template<typename T>
+inline size_t CollisionGrid<T>::countInSectors(int x0, int y0, int x1, int y1) const
+{
+	x0 = std::max(x0, 0);
+	y0 = std::max(y0, 0);
+	x1 = std::min(x1, sectorsX - 1);
+	y1 = std::min(y1, sectorsY - 1);
+	if (x0 > x1 || y0 > y1) return 0;
+
+	const size_t stride = sectorsY + 1;
+	return sectorCountsSum[(x1 + 1) * stride + y1 + 1] - sectorCountsSum[x0 * stride + y1 + 1]
+		- sectorCountsSum[(x1 + 1) * stride + y0] + sectorCountsSum[x0 * stride + y0];
+}
+
+template<typename T>
+inline size_t CollisionGrid<T>::countInRange(const sf::Vector2f & position, double range) const
+{
+	return countInBlock(*this, getSectorsInRange(position, range));
+}
+
+template<typename T>
+inline uint64_t CollisionGrid<T>::getRowOccupancy(int y, int word) const
+{
+	return rowOccupancy[static_cast<size_t>(y) * rowWords + word];
+}
+
+template<typename T>
+inline uint64_t CollisionGrid<T>::getColumnOccupancy(int x, int word) const
+{
+	return columnOccupancy[static_cast<size_t>(x) * columnWords + word];
+}
+
+template<typename T>
+inline typename CollisionGrid<T>::SectorBlock CollisionGrid<T>::getSectorsInRange(const sf::Vector2f & position, double range) const
+{
+	// +1 - margin for float rounding of distances compared with range
+	range += 1;
+
+	// clamped in double - range can be larger than int
+	auto sector = [this](double coordinate, int count) {
+		return static_cast<int>(std::min(std::max(std::floor(coordinate / sectorSize), 0.0), count - 1.0));
+	};
+	return SectorBlock{ sector(position.x - range, sectorsX), sector(position.y - range, sectorsY),
+		sector(position.x + range, sectorsX), sector(position.y + range, sectorsY) };
+}
+
+template<typename T>
+template<typename Occupancy>
+inline size_t CollisionGrid<T>::countInBlock(const Occupancy & occupancy, const SectorBlock & block)
+{
+	return occupancy.countInSectors(block.x0, block.y0, block.x1, block.y1);
+}
+
+template<typename T>
+inline int CollisionGrid<T>::lowestSetBit(uint64_t bits)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long index;
+	_BitScanForward64(&index, bits);
+	return static_cast<int>(index);
+#elif defined(_MSC_VER)
+	unsigned long index;
+	if (_BitScanForward(&index, static_cast<unsigned long>(bits))) return static_cast<int>(index);
+	_BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+	return static_cast<int>(index) + 32;
+#else
+	return __builtin_ctzll(bits);
+#endif
+}
+
+template<typename T>
+template<typename Occupancy, typename SectorVisitor, typename LimitFunction>
+inline void CollisionGrid<T>::visitRings(const sf::Vector2f & position, const Occupancy & occupancy, SectorVisitor visitSector, LimitFunction limit) const
+{
+	const auto center = getSectorCoords(position);
+
+	// last ring that has any sector inside grid
+	const int lastRing = std::max(std::max(center.x, sectorsX - 1 - center.x), std::max(center.y, sectorsY - 1 - center.y));
+
+	for (int r = 0; r <= lastRing; ++r)
+	{
+		// rings 0..r-1
+		const SectorBlock visited{ center.x - r + 1, center.y - r + 1, center.x + r - 1, center.y + r - 1 };
+
+		if (r > 0)
+		{
+			// distance from position to the border of already visited rings - nothing in ring r is closer
+			auto bound = std::min(
+				std::min(position.x - (center.x - r + 1) * sectorSize, (center.x + r) * sectorSize - position.x),
+				std::min(position.y - (center.y - r + 1) * sectorSize, (center.y + r) * sectorSize - position.y));
+
+			if (bound > 0 && static_cast<double>(bound) * bound > limit()) break;
+		}
+
+		// every object within limit was already visited
+		auto inLimit = getSectorsInRange(position, std::sqrt(limit()));
+		SectorBlock visitedInLimit{ std::max(inLimit.x0, visited.x0), std::max(inLimit.y0, visited.y0),
+			std::min(inLimit.x1, visited.x1), std::min(inLimit.y1, visited.y1) };
+		if (countInBlock(occupancy, inLimit) == countInBlock(occupancy, visitedInLimit)) break;
+
+		// ring without objects
+		SectorBlock ring{ center.x - r, center.y - r, center.x + r, center.y + r };
+		if (countInBlock(occupancy, ring) == countInBlock(occupancy, visited)) continue;
+
+		visitRing(center, r, occupancy, visitSector);
+	}
+}
+
+template<typename T>
+template<typename Occupancy, typename SectorVisitor>
+inline void CollisionGrid<T>::visitRing(sf::Vector2i center, int r, const Occupancy & occupancy, SectorVisitor visitSector) const
+{
+	if (r == 0)
+	{
+		visitSector(center.x, center.y);
+		return;
+	}
+
+	// top and bottom rows with corners, then left and right columns - set bits of both lines are walked
+	// in one pass, so sectors are visited in the same order as by plain loop over the ring
+	// lineWord(line, word) - occupancy word of line, visit(line, i) - visits i-th sector of line
+	auto visitLines = [&](int first, int last, int lineA, int lineB, int lineCount, int sectorCount, auto lineWord, auto visit) {
+		first = std::max(first, 0);
+		last = std::min(last, sectorCount - 1);
+		if (first > last) return;
+
+		const bool hasA = lineA >= 0 && lineA < lineCount;
+		const bool hasB = lineB >= 0 && lineB < lineCount;
+
+		for (int word = first / 64; word <= last / 64; ++word)
+		{
+			uint64_t bitsA = hasA ? lineWord(lineA, word) : 0;
+			uint64_t bitsB = hasB ? lineWord(lineB, word) : 0;
+
+			// only bits of sectors first..last
+			uint64_t mask = ~uint64_t(0);
+			if (word == first / 64) mask &= ~uint64_t(0) << (first % 64);
+			if (word == last / 64 && last % 64 != 63) mask &= (uint64_t(1) << (last % 64 + 1)) - 1;
+
+			for (uint64_t bits = (bitsA | bitsB) & mask; bits != 0; bits &= bits - 1)
+			{
+				int index = lowestSetBit(bits);
+				auto bit = uint64_t(1) << index;
+				int i = word * 64 + index;
+				if (bitsA & bit) visit(lineA, i);
+				if (bitsB & bit) visit(lineB, i);
+			}
+		}
+	};
+
+	visitLines(center.x - r, center.x + r, center.y - r, center.y + r, sectorsY, sectorsX,
+		[&](int y, int word) { return occupancy.getRowOccupancy(y, word); },
+		[&](int y, int x) { visitSector(x, y); });
+	visitLines(center.y - r + 1, center.y + r - 1, center.x - r, center.x + r, sectorsX, sectorsY,
+		[&](int x, int word) { return occupancy.getColumnOccupancy(x, word); },
+		[&](int x, int y) { visitSector(x, y); });
+}
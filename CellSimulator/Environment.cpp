@@ -1,25 +1,25 @@
 #include "Environment.h"
-#include "CellSimApp.h"
 #include "Logger.h"
-#include "CellSimMouse.h"
-#include "CellSelectionTool.h"
-#include "CellInsertionTool.h"
-#include "FoodBrush.h"
 #include <math.h>
 #include <random>
 #include <algorithm>
 #include <atomic>
-#include "TextureProvider.h"
-#include "CellMovementTool.h"
 #include "FoodManager.h"
-#include "AutoFeederTool.h"
+#include "SimulationClock.h"
+#include "MortonCode.h"
+#include "CellStore.h"
+#include "WorkerPool.h"
 #include "Distance.h"
 #include "RegexPattern.h"
 #include "CellFactory.h"
+#include "CellRoles.h"
 #include "MessagesManager.h"
+#include "DoubleToString.h"
 #include <sstream>
 #include <regex>
 
+thread_local std::vector<Environment::ActIntent>* Environment::actIntents = nullptr;
+
 Environment::~Environment()
 {
 }
@@ -41,33 +41,26 @@ void Environment::sterilizeEnvironment()
 	for (auto& o : cells) o->markToDelete();
 	for(auto& o : newCells) o->markToDelete();
 	for (auto& o : deadCells) o->markToDelete();
-	for (auto& o : food) o->markToDelete();
-	for (auto& o : newFood) o->markToDelete();
-
 	cells.clear();
 	newCells.clear();
 	deadCells.clear();
 	
 	food.clear();
-	newFood.clear();
 
-	for (auto& c : cellCollisionSectors)
-	{
-		for (auto& cc : c)
-			cc.clear();
-	}
+	killedCells.clear();
+	removedDeadCells.clear();
 
-	for (auto& f : foodCollisionSectors)
-	{
-		for (auto& ff : f)
-			ff.clear();
-	}
+	cellCollisionSectors.clear();
+	foodCollisionSectors.clear();
+	neighbourLists.invalidate();
 }
 
-void Environment::configure(sf::Vector2f envSize, bool fill)
+void Environment::configure(sf::Vector2f envSize, bool fill, uint32_t seed)
 {
 	sterilizeEnvironment();
 
+	setSeed(seed != 0 ? seed : randomSeed());
+
 	//backgroundDefaultColor = sf::Color{ 170, 135, 200 };
 	//backgroundDefaultColor = sf::Color{ 50, 60, 40 };
 	backgroundDefaultColor = sf::Color{ 170 / 3, 135 / 3, 200 / 3 };
@@ -78,26 +71,20 @@ void Environment::configure(sf::Vector2f envSize, bool fill)
 	eb.setOutlineColor(sf::Color::Red);
 	eb.setOutlineThickness(5);
 	eb.setPosition(sf::Vector2f{ 0,0 });
+	// texture itself is set by app (setBackgroundTexture) - only its scale depends on size
 	eb.setTextureRect(sf::IntRect(0, 0, eb.getSize().x / 4, eb.getSize().y / 4));
-	TextureProvider::getInstance().getTexture("background2")->setSmooth(false);
-	eb.setTexture(TextureProvider::getInstance().getTexture("background2").get());
-
-	CellSimApp::getInstance().getView().setCenter(eb.getSize() / 2.0f);
-
-	int sectorsX = getSize().x / sectorSize + 1;
-	int sectorsY = getSize().y / sectorSize + 1;
-
-	cellCollisionSectors.resize(sectorsX);
-	for (int i = 0; i < sectorsX; ++i)
-	{
-		cellCollisionSectors[i].resize(sectorsY);
-	}
 
-	foodCollisionSectors.resize(sectorsX);
-	for (int i = 0; i < sectorsX; ++i)
-	{
-		foodCollisionSectors[i].resize(sectorsY);
-	}
+	sectorSize = defaultSectorSize;
+	coarseLevels = 2;
+	sectorsTuned = false;
+	stepsToSectorTuning = 0;
+	stepsToCellsSort = 0;
+	// saves without boundary mode come from worlds with walls
+	boundaryMode = BoundaryMode::Reflect;
+	// new worlds and saves without the key search targets in every step
+	setTargetSearchInterval(1);
+	neighbourLists.setSkin(NeighbourLists::defaultSkin);
+	configureCollisionSectors();
 
 	if (fill)
 	{
@@ -207,7 +194,7 @@ void Environment::configure(std::string formattedEnvString)
 		}
 		else if (std::regex_search(lines[i].begin(), lines[i].end(), foodHeader))
 		{
-			insertNewFood(Food::create(lines[i]));
+			insertNewFood(Food(lines[i]));
 		}
 		else Logger::log("Not recognized data format in environment save string.");
 	}
@@ -218,41 +205,36 @@ void Environment::configure(std::string formattedEnvString)
 
 void Environment::updateBackground()
 {
-	static double threshold = 30;
-	int newR, newG, newB;
+	environmentBackground.setFillColor(backgroundDefaultColor + getEnvironmentTint());
+}
 
-	auto newColor = backgroundDefaultColor;
+sf::Color Environment::getEnvironmentTint()
+{
+	constexpr double threshold = 30;
+	const double temperature = _temperature;
+	const double radiation = _radiation;
 
-	//temperature
-	auto& envTemp = _temperature;
-	auto& envRad = _radiation;
-	if (envTemp > threshold)
-	{
-		newR = 2 * abs(envTemp - threshold) + backgroundDefaultColor.r;
-		if (newR > 255) newR = 255;
-		newColor.r = newR;
-	}
-	else if (envTemp < -threshold)
-	{
-		newB = 2 * abs(envTemp + threshold) + backgroundDefaultColor.b;
-		if (newB > 255) newB = 255;
-		newColor.b = newB;
-	}
+	// alpha 0 - added colour keeps transparency, channels saturate at 255
+	sf::Color tint(0, 0, 0, 0);
+	if (temperature > threshold)
+		tint.r = static_cast<sf::Uint8>(std::min(2 * (temperature - threshold), 255.0));
+	else if (temperature < -threshold)
+		tint.b = static_cast<sf::Uint8>(std::min(2 * (-threshold - temperature), 255.0));
 
-	//radiation
-	if (envRad > threshold)
-	{
-		newG = 3 * abs(envRad - threshold) + backgroundDefaultColor.g;
-		if (newG > 255) newG = 255;
-		newColor.g = newG;
-	}
+	if (radiation > threshold)
+		tint.g = static_cast<sf::Uint8>(std::min(3 * (radiation - threshold), 255.0));
 
-	environmentBackground.setFillColor(newColor);
+	return tint;
 }
 
-void Environment::update()
+void Environment::update(const float& deltaTime)
 {
-	sf::Vector2f mouse = CellSimMouse::getPosition();
+	this->deltaTime = deltaTime;
+	// changes of temperature or radiation made during step apply from next one
+	tickContext = makeTickContext();
+
+	// rows of cells destroyed in previous step - nothing iterates over store here
+	CellStore::getInstance().compact();
 
 	_aliveCellsCount = cells.size();
 	_foodCount = food.size();
@@ -265,87 +247,300 @@ void Environment::update()
 		sterilizeEnvironment();
 	}
 
-	CellMovementTool::getInstance().update();
-	CellSelectionTool::getInstance().update();
-	AutoFeederTool::getInstance().update();
-	CellInsertionTool::getInstance().update();
-	FoodBrush::getInstance().update();
+	if (stepHook)
+		stepHook();
 
 	for (auto& newCell : newCells)
 	{
 		cells.push_back(newCell);
+		// killed before it was moved to cells vector - e.g. loaded dead cell
+		if (newCell->isDead()) killedCells.push_back(newCell.get());
 	}
 	newCells.clear();
 
-	for (auto& f : newFood)
-	{
-		food.push_back(f);
-	}
-	newFood.clear();
 
 	// call role-functions for all cells
 	if (_simulationActive)
 	{
-		for (auto& f : food)
+		SimulationClock::getInstance().step(deltaTime);
+
+		auto& workers = WorkerPool::getInstance();
+
+		workers.parallelFor(food.size(), [this, deltaTime](size_t begin, size_t end) {
+			for (auto i = begin; i < end; ++i)
+				food[i].update(deltaTime);
+		});
+
+		if (--stepsToSectorTuning <= 0)
+			tuneCollisionSectors();
+
+		if (cellsSortInterval > 0 && --stepsToCellsSort <= 0)
+			sortCellsBySectors();
+
+		// sense phase reads sectors only - moves, births and deaths are picked up in next step
+		// queries select levels in food grid - both grids build the same levels
+		auto levels = foodCollisionSectors.takeRequestedLevels(cells.size() + food.size());
+		cellCollisionSectors.rebuild(cells, levels);
+		foodCollisionSectors.rebuild(food.size(),
+			[this](size_t i) { return food[i].position; },
+			[this](size_t i) { return food[i].size; },
+			levels);
+
+		neighbourLists.update(cells, static_cast<float>(Food::growthSpeed * deltaTime));
+
+		groupByArchetype(cells);
+
+		// sense phase - cells only read their surroundings
+		senseByArchetype();
+
+		contactPairs.clear();
+		for (auto& cell : cells)
 		{
-			f->update();
+			if (!cell->isFreezed())
+				CellRoles::collectContactPairs(cell.get(), contactPairs);
 		}
 
+		// act phase - births are deferred to newCells, eaten food is removed from store at once
+		actByArchetype();
+
+		// pairs touch two cells and insert newborns - resolved sequentially in order of cells vector
+		for (auto& pair : contactPairs)
+			CellRoles::resolveContactPair(pair.first, pair.second);
+
 		for (auto& cell : cells)
 		{
-			cell->update();
-
 			if (cell->isDead())
 				deadCells.push_back(cell);
 		}
 
+		// dead cells have no sense roles
+		groupByArchetype(deadCells);
+		actByArchetype();
+
 		for (auto& cell : deadCells)
 		{
-			cell->update();
+			if (cell->isMarkedToDelete())
+				removedDeadCells.push_back(cell.get());
 		}
 	}
 
-	CellSelectionTool::getInstance().updateSelectionMarker();
+	//remove cells marked as dead
+	if (!killedCells.empty())
+	{
+		auto newCellsEnd = std::remove_if(cells.begin(), cells.end(), [](auto c) {return c->isDead(); });
+		cells.erase(newCellsEnd, cells.end());
+		killedCells.clear();
+	}
 
-	//remove food marked to delete in role-functions
-	auto newFoodEnd = std::remove_if(food.begin(), food.end(), [](auto f) {return f->isMarkedToDelete(); });
-	food.erase(newFoodEnd, food.end());
+	//remove dead cells marked to delete
+	if (!removedDeadCells.empty())
+	{
+		auto newDeadCellsEnd = std::remove_if(deadCells.begin(), deadCells.end(), [](auto c) {return c->isMarkedToDelete(); });
+		deadCells.erase(newDeadCellsEnd, deadCells.end());
+		removedDeadCells.clear();
+	}
+}
 
-	//remove food from collision sectors
-	for (auto& f : foodCollisionSectors)
-		for (auto& ff : f)
-			ff.erase(std::remove_if(ff.begin(), ff.end(), [](std::shared_ptr<BaseObj> e) {return e->isMarkedToDelete(); }), ff.end());
+void Environment::groupByArchetype(const std::vector<std::shared_ptr<Cell>>& cellsToGroup)
+{
+	for (auto& group : archetypeGroups)
+		group.clear();
 
-	//remove cells marked as dead
-	auto newCellsEnd = std::remove_if(cells.begin(), cells.end(), [](auto c) {return c->isDead(); });
-	cells.erase(newCellsEnd, cells.end());
+	for (auto& cell : cellsToGroup)
+	{
+		if (cell->isFreezed()) continue;
+
+		auto archetype = static_cast<size_t>(cell->getArchetype());
+		if (archetype >= archetypeGroups.size())
+			archetypeGroups.resize(archetype + 1);
+		archetypeGroups[archetype].push_back(cell.get());
+	}
+}
 
-	//remove cells marked as dead from collision sectors
-	for (auto& c : cellCollisionSectors)
-		for (auto& cc : c)
-			cc.erase(std::remove_if(cc.begin(), cc.end(), [](std::shared_ptr<BaseObj> e) {return e->isMarkedToDelete(); }), cc.end());
+void Environment::senseByArchetype()
+{
+	auto& workers = WorkerPool::getInstance();
+	auto& manager = CellRoles::getManager();
 
-	//remove dead cells marked to delete
-	auto newDeadCellsEnd = std::remove_if(deadCells.begin(), deadCells.end(), [](auto c) {return c->isMarkedToDelete(); });
-	deadCells.erase(newDeadCellsEnd, deadCells.end());
+	for (size_t archetype = 0; archetype < archetypeGroups.size(); ++archetype)
+	{
+		auto& group = archetypeGroups[archetype];
+		auto& roles = manager.getArchetypeSenseRoles(static_cast<int>(archetype));
+		if (group.empty() || roles.empty()) continue;
+
+		workers.parallelFor(group.size(), [this, &group, &roles](size_t begin, size_t end) {
+			for (auto& fn : roles)
+				for (auto i = begin; i < end; ++i)
+					group[i]->runRole(fn, tickContext);
+		}, 16);
+	}
+}
+
+void Environment::actByArchetype()
+{
+	auto& manager = CellRoles::getManager();
+
+	for (size_t archetype = 0; archetype < archetypeGroups.size(); ++archetype)
+	{
+		auto& group = archetypeGroups[archetype];
+		auto& roles = manager.getArchetypeActRoles(static_cast<int>(archetype));
+		if (group.empty()) continue;
+
+		size_t firstRole = 0;
+		while (firstRole < roles.size())
+		{
+			auto fn = roles[firstRole];
+			if (!CellRoles::isSequentialRole(fn))
+			{
+				// run of roles that touch only their own cell
+				auto lastRole = firstRole + 1;
+				while (lastRole < roles.size() && !CellRoles::isSequentialRole(roles[lastRole]))
+					++lastRole;
+				actInChunks(group, static_cast<int>(archetype), roles, firstRole, lastRole);
+				firstRole = lastRole;
+				continue;
+			}
+
+			for (auto cell : group)
+			{
+				// roles changed during this step (e.g. cell was killed) - rest of old roles is skipped
+				if (cell->hasArchetype(static_cast<int>(archetype)))
+					cell->runRole(fn, tickContext);
+			}
+			++firstRole;
+		}
+	}
+}
+
+void Environment::actInChunks(const std::vector<Cell*>& group, int archetype, const std::vector<CellRoles::RolePtr>& roles, size_t firstRole, size_t lastRole)
+{
+	auto chunksCount = (group.size() + actChunkSize - 1) / actChunkSize;
+	if (actChunks.size() < chunksCount)
+		actChunks.resize(chunksCount);
+	auto rolesCount = lastRole - firstRole;
+
+	WorkerPool::getInstance().parallelFor(chunksCount, [this, &group, archetype, &roles, firstRole, rolesCount](size_t beginChunk, size_t endChunk) {
+		for (auto chunk = beginChunk; chunk < endChunk; ++chunk)
+		{
+			auto begin = chunk * actChunkSize;
+			auto end = std::min(begin + actChunkSize, group.size());
+			auto& roleIntents = actChunks[chunk].roleIntents;
+			roleIntents.resize(rolesCount);
+
+			for (size_t i = 0; i < rolesCount; ++i)
+			{
+				auto fn = roles[firstRole + i];
+				roleIntents[i].clear();
+				actIntents = &roleIntents[i];
+
+				auto batch = CellRoles::getBatchRole(fn);
+				if (batch != nullptr)
+				{
+					batch(group.data() + begin, end - begin, archetype, tickContext);
+					continue;
+				}
+
+				for (auto j = begin; j < end; ++j)
+				{
+					// roles changed during this step (e.g. cell was killed) - rest of old roles is skipped
+					if (group[j]->hasArchetype(archetype))
+						group[j]->runRole(fn, tickContext);
+				}
+			}
+			actIntents = nullptr;
+		}
+	}, 1);
+
+	for (size_t i = 0; i < rolesCount; ++i)
+	{
+		for (size_t chunk = 0; chunk < chunksCount; ++chunk)
+		{
+			for (auto& intent : actChunks[chunk].roleIntents[i])
+			{
+				if (intent.killed != nullptr)
+					registerKilledCell(intent.killed);
+				else
+					insertNewFood(intent.food);
+			}
+		}
+	}
+}
+
+void Environment::setStepHook(std::function<void()> hook)
+{
+	stepHook = hook;
+}
+
+void Environment::setBackgroundTexture(const sf::Texture * texture)
+{
+	environmentBackground.setTexture(texture);
 }
 
 void Environment::draw(sf::RenderWindow & window)
 {
 	window.draw(environmentBackground);
+
+	// objects outside of view are skipped - their shapes are not updated at all
+	const auto& view = window.getView();
+	sf::FloatRect visibleArea(view.getCenter() - view.getSize() / 2.f, view.getSize());
+	auto isVisible = [&visibleArea](const sf::Vector2f& position, float size) {
+		return visibleArea.intersects(sf::FloatRect(position.x - size, position.y - size, 2 * size, 2 * size));
+	};
+
 	for (auto & f : food) {
-		window.draw(*f);
+		if (!isVisible(f.position, f.size)) continue;
+		// unit circle scaled to food size - points of shape are not rebuilt for every food
+		foodShape.setScale(f.size, f.size);
+		foodShape.setPosition(f.position);
+		foodShape.setFillColor(f.color);
+		window.draw(foodShape);
 	}
 	for (auto & cell : deadCells) {
-		window.draw(*cell);
+		if (isVisible(cell->getPosition(), cell->getSize()))
+			window.draw(*cell);
 	}
+	// the same tint for all cells - computed once per frame, cells update colours only when it changed
+	const auto tint = getEnvironmentTint();
 	for (auto & cell : cells) {
+		if (!isVisible(cell->getPosition(), cell->getSize())) continue;
+		cell->applyEnvironmentTint(tint);
 		window.draw(*cell);
 	}
-	CellSelectionTool::getInstance().draw(window);
-	CellMovementTool::getInstance().draw(window);
-	CellInsertionTool::getInstance().draw(window);
-	FoodBrush::getInstance().draw(window);
+}
+
+const float& Environment::getDeltaTime()
+{
+	return deltaTime;
+}
+
+const TickContext & Environment::getTickContext()
+{
+	return tickContext;
+}
+
+TickContext Environment::makeTickContext()
+{
+	TickContext context;
+	context.deltaTime = deltaTime;
+	context.temperature = _temperature;
+	context.radiation = _radiation;
+	context.envSize = getSize();
+	context.wrap = boundaryMode == BoundaryMode::Wrap;
+	return context;
+}
+
+uint32_t Environment::getSeed()
+{
+	return seed;
+}
+
+void Environment::setSeed(uint32_t seed)
+{
+	this->seed = seed;
+	nextStreamId = 1;
+
+	// stream 0 is used by environment itself (random fill, food generation, user tools)
+	defaultRandomStream().seed(seed, 0);
 }
 
 std::atomic<double>& Environment::getTemperature()
@@ -358,6 +553,16 @@ void Environment::setTemperature(const double& t)
 	_temperature = t;
 }
 
+std::atomic<int>& Environment::getTargetSearchInterval()
+{
+	return _targetSearchInterval;
+}
+
+void Environment::setTargetSearchInterval(const int & i)
+{
+	_targetSearchInterval = std::max(i, 1);
+}
+
 std::atomic<double>& Environment::getRadiation()
 {
 	return _radiation;
@@ -373,6 +578,23 @@ sf::Vector2f Environment::getSize()
 	return environmentBackground.getSize();
 }
 
+Environment::BoundaryMode Environment::getBoundaryMode()
+{
+	return boundaryMode;
+}
+
+void Environment::setBoundaryMode(BoundaryMode mode)
+{
+	boundaryMode = mode;
+	// contacts across borders appear or disappear
+	neighbourLists.invalidate();
+}
+
+sf::Vector2f Environment::wrapDisplacement(sf::Vector2f displacement)
+{
+	return TickContext::wrapDisplacement(displacement, getSize());
+}
+
 int Environment::getAliveCellsCount()
 {
 	return _aliveCellsCount;
@@ -392,7 +614,7 @@ std::shared_ptr<Cell> Environment::getCellAtPosition(const sf::Vector2f & p)
 	return nullptr;
 }
 
-const std::vector<std::shared_ptr<Food>>& Environment::getFoodsVector()
+FoodStore & Environment::getFoodStore()
 {
 	return food;
 }
@@ -407,35 +629,169 @@ std::vector<std::shared_ptr<Cell>>& Environment::getNewCellsVector()
 	return newCells;
 }
 
-const std::vector<std::shared_ptr<Food>>& Environment::getNewFoodsVector()
+HierarchicalGrid<Cell>& Environment::getCellCollisionSectors()
 {
-	return newFood;
+	return cellCollisionSectors;
 }
 
-baseObjMatrix& Environment::getCellCollisionSectors()
+HierarchicalGrid<Food>& Environment::getFoodCollisionSectors()
 {
-	return cellCollisionSectors;
+	return foodCollisionSectors;
 }
 
-baseObjMatrix& Environment::getFoodCollisionSectors()
+void Environment::setHierarchicalGrid(bool enabled)
 {
-	return foodCollisionSectors;
+	hierarchicalGrid = enabled;
+	configureCollisionSectors();
+}
+
+bool Environment::isHierarchicalGrid()
+{
+	return hierarchicalGrid;
+}
+
+void Environment::configureCollisionSectors()
+{
+	// same geometry - cells search both grids in one pass
+	// levels from sectorSize / 2 (contacts, crowded areas) to long radar ranges in empty areas
+	int levelsCount = hierarchicalGrid ? 2 + coarseLevels : 1;
+	int baseLevel = hierarchicalGrid ? 1 : 0;
+	cellCollisionSectors.configure(getSize(), sectorSize, levelsCount, baseLevel);
+	foodCollisionSectors.configure(getSize(), sectorSize, levelsCount, baseLevel);
+}
+
+void Environment::tuneCollisionSectors()
+{
+	stepsToSectorTuning = sectorTuningInterval;
+	if (cells.empty()) return;
+
+	std::vector<float> radii;
+	radii.reserve(cells.size());
+
+	float largestRadius = 0;
+	float radarRange = 0;
+	for (auto& cell : cells)
+	{
+		radii.push_back(cell->getSize());
+		largestRadius = std::max(largestRadius, cell->getSize());
+		radarRange = std::max(radarRange, static_cast<float>(cell->getGenes().radarRange.get()));
+	}
+	for (size_t i = 0; i < food.size(); ++i)
+		largestRadius = std::max(largestRadius, food[i].size);
+
+	// 90% of cells are not bigger
+	auto nth = radii.begin() + radii.size() * 9 / 10;
+	std::nth_element(radii.begin(), nth, radii.end());
+	auto radius = *nth;
+	auto skin = neighbourLists.getSkin();
+
+	// contacts of most cells (including neighbour list margin) are found in center sector and first ring
+	// food and cells share the size - queries come from cells, so size depends on cells, not on food radius
+	float size = radius + largestRadius + skin;
+	if (size < minSectorSize) size = minSectorSize;
+	if (size > maxSectorSize) size = maxSectorSize;
+
+	// coarsest level covers the longest radar range in two rings - levels are built only when used,
+	// so spare coarse levels cost nothing and are removed only together with size change
+	int coarse = 0;
+	while (coarse < 4 && 2 * size * (1 << coarse) < radarRange)
+		++coarse;
+
+	bool drifted = size > 1.25f * sectorSize || size < 0.75f * sectorSize || coarse > coarseLevels;
+	if (sectorsTuned && !drifted) return;
+
+	Logger::log("Collision sectors: size " + doubleToString(size, 1) +
+		" (90% of cells radius <= " + doubleToString(radius, 1) + ", largest object " + doubleToString(largestRadius, 1) + ", skin " + doubleToString(skin, 1) + ")" +
+		", coarse levels: " + std::to_string(coarse) + " (longest radar range " + doubleToString(radarRange, 1) + ")" +
+		(sectorsTuned ? " - population drifted from previous tuning." : "."));
+
+	sectorSize = size;
+	coarseLevels = coarse;
+	sectorsTuned = true;
+	configureCollisionSectors();
+}
+
+NeighbourLists & Environment::getNeighbourLists()
+{
+	return neighbourLists;
 }
 
 void Environment::insertNewCell(std::shared_ptr<Cell> c)
 {
+	c->seedRandomStream(seed, nextStreamId++);
 	newCells.push_back(c);
+}
+
+void Environment::insertNewFood(const Food & f)
+{
+	if (actIntents != nullptr)
+	{
+		actIntents->push_back(ActIntent{ nullptr, f });
+		return;
+	}
 
-	auto coords = getCollisionSectorCoords(c);
-	cellCollisionSectors[coords.x][coords.y].push_back(c);
+	auto handle = food.insert(f);
+	if (handle.isValid())
+		neighbourLists.insertFood(handle);
 }
 
-void Environment::insertNewFood(std::shared_ptr<Food> f)
+void Environment::sortCellsBySectors()
 {
-	newFood.push_back(f);
+	stepsToCellsSort = cellsSortInterval;
+
+	// key - Morton code of sector at base level, ties keep current order (cells of one sector are not shuffled)
+	cellsSortKeys.clear();
+	for (size_t i = 0; i < cells.size(); ++i)
+	{
+		auto position = cells[i]->getPosition();
+		auto x = static_cast<uint16_t>(std::min(std::max(position.x / sectorSize, 0.0f), 65535.0f));
+		auto y = static_cast<uint16_t>(std::min(std::max(position.y / sectorSize, 0.0f), 65535.0f));
+		cellsSortKeys.emplace_back(mortonCode(x, y), static_cast<uint32_t>(i));
+	}
+
+	// between sorts cells move a little and newborns are appended - order is mostly kept
+	if (std::is_sorted(cellsSortKeys.begin(), cellsSortKeys.end())) return;
+	std::sort(cellsSortKeys.begin(), cellsSortKeys.end());
+
+	sortedCells.clear();
+	sortedRows.clear();
+	for (auto& key : cellsSortKeys)
+	{
+		sortedCells.push_back(std::move(cells[key.second]));
+		sortedRows.push_back(sortedCells.back()->getStoreRow());
+	}
+	cells.swap(sortedCells);
+	sortedCells.clear();
 
-	auto coords = getCollisionSectorCoords(f);
-	foodCollisionSectors[coords.x][coords.y].push_back(f);
+	CellStore::getInstance().reorder(sortedRows);
+}
+
+int Environment::getCellsSortInterval()
+{
+	return cellsSortInterval;
+}
+
+void Environment::setCellsSortInterval(int interval)
+{
+	cellsSortInterval = std::max(interval, 0);
+	stepsToCellsSort = std::min(stepsToCellsSort, cellsSortInterval);
+}
+
+void Environment::removeFood(FoodHandle f)
+{
+	food.remove(f);
+}
+
+void Environment::registerKilledCell(Cell * c)
+{
+	if (actIntents != nullptr)
+	{
+		actIntents->push_back(ActIntent{ c, Food() });
+		return;
+	}
+
+	if (!c->getName().empty()) MessagesManager::getInstance().append(c->getName() + " died [*].");
+	killedCells.push_back(c);
 }
 
 std::string Environment::getSaveString()
@@ -446,49 +802,68 @@ std::string Environment::getSaveString()
 		VarAbbrv::envSize << ":{" << this->environmentBackground.getSize().x << ", " << this->environmentBackground.getSize().y << "} " <<
 		VarAbbrv::radiation << ":" << this->getRadiation() << " " <<
 		VarAbbrv::temperature << ":" << this->getTemperature() << " " <<
-		VarAbbrv::isSimualtionActive << ":" << this->getIsSimulationActive() << " " << std::endl << std::endl;
+		VarAbbrv::isSimualtionActive << ":" << this->getIsSimulationActive() << " " <<
+		VarAbbrv::seed << ":" << this->getSeed() << " " <<
+		VarAbbrv::targetSearchInterval << ":" << this->getTargetSearchInterval() << " " <<
+		VarAbbrv::neighbourSkin << ":" << this->neighbourLists.getSkin() << " " <<
+		VarAbbrv::boundaryMode << ":" << static_cast<int>(this->boundaryMode) << " " << std::endl << std::endl;
 
 	for (auto& o : newCells) result << o->getSaveString() << std::endl;
 	for (auto& o : cells) result << o->getSaveString() << std::endl;
 	for (auto& o : deadCells) result << o->getSaveString() << std::endl;
 	result << std::endl;
-	for (auto& o : newFood) result << o->getSaveString() << std::endl;
-	for (auto& o : food) result << o->getSaveString() << std::endl;
+	for (auto& o : food) result << o.getSaveString() << std::endl;
 
 	return result.str();
 }
 
 Environment::Environment()
 {
+	deltaTime = 0;
+	seed = 0;
+	nextStreamId = 0;
+	_targetSearchInterval = 1;
+	hierarchicalGrid = true;
+	boundaryMode = BoundaryMode::Reflect;
+	sectorSize = defaultSectorSize;
+	coarseLevels = 2;
+	stepsToSectorTuning = 0;
+	sectorsTuned = false;
+	cellsSortInterval = defaultCellsSortInterval;
+	stepsToCellsSort = 0;
 	_clearEnvironment = false;
 	_simulationActive = true;
-	_wasAutofeederActive = AutoFeederTool::getInstance().getIsActive();
+
+	foodShape.setRadius(1);
+	foodShape.setOrigin(1, 1);
 }
 
 bool Environment::isObjInEnvironmentBounds(BaseObj::Ptr o, float expectedSize)
 {
-	const auto& envSize = getSize();
-	const auto& cellPos = o->getPosition();
+	return isObjInEnvironmentBounds(o->getPosition(), expectedSize == 0 ? o->getSize() : expectedSize);
+}
 
-	const float size = (expectedSize == 0 ? o->getSize() : expectedSize);
+bool Environment::isObjInEnvironmentBounds(const sf::Vector2f & position, float size)
+{
+	const auto& envSize = getSize();
 
 	//check left bound
-	if (o->getPosition().x - size <= 0)
+	if (position.x - size <= 0)
 	{
 		return false;
 	}
 	//check right bound
-	else if (o->getPosition().x + size >= envSize.x)
+	else if (position.x + size >= envSize.x)
 	{
 		return false;
 	}
 	//check top bound
-	else if (o->getPosition().y - size <= 0)
+	else if (position.y - size <= 0)
 	{
 		return false;
 	}
 	//check bottom bound
-	else if (o->getPosition().y + size >= envSize.y)
+	else if (position.y + size >= envSize.y)
 	{
 		return false;
 	}
@@ -503,6 +878,10 @@ void Environment::modifyValueFromString(std::string valueName, std::string value
 	if (v == VarAbbrv::isSimualtionActive)		this->_simulationActive = (std::stod(value));
 	else if (v == VarAbbrv::radiation)			this->_radiation = (std::stod(value));
 	else if (v == VarAbbrv::temperature)		this->_temperature = (std::stod(value));
+	else if (v == VarAbbrv::seed)				this->setSeed(std::stoul(value));
+	else if (v == VarAbbrv::targetSearchInterval)	this->setTargetSearchInterval(std::stoi(value));
+	else if (v == VarAbbrv::neighbourSkin)		this->neighbourLists.setSkin(std::stof(value));
+	else if (v == VarAbbrv::boundaryMode)		this->setBoundaryMode(std::stoi(value) == static_cast<int>(BoundaryMode::Wrap) ? BoundaryMode::Wrap : BoundaryMode::Reflect);
 	else Logger::log(std::string("Unknown environment var name '" + v + "' with value '" + value + "'!"));
 }
 
@@ -521,18 +900,11 @@ void Environment::modifyValueFromVector(std::string valueName, const std::vector
 	}
 }
 
-sf::Vector2i Environment::getCollisionSectorCoords(std::shared_ptr<BaseObj> o)
-{
-	return sf::Vector2i(o->getPosition().x / sectorSize, o->getPosition().y / sectorSize);
-}
-
 void Environment::pauseSimulation()
 {
 	if (_simulationActive)
 		MessagesManager::getInstance().append("Simulation paused.");
 	_simulationActive = false;
-	_wasAutofeederActive = AutoFeederTool::getInstance().getIsActive();
-	AutoFeederTool::getInstance().setIsActive(false);
 }
 
 void Environment::startSimualtion()
@@ -540,8 +912,6 @@ void Environment::startSimualtion()
 	if (!_simulationActive)
 		MessagesManager::getInstance().append("Simulation resumed.");
 	_simulationActive = true;
-	if (_wasAutofeederActive)
-		AutoFeederTool::getInstance().setIsActive(true);
 }
 
 std::atomic_bool & Environment::getIsSimulationActive()
@@ -2,92 +2,235 @@
 #include <SFML/Graphics.hpp>
 #include <vector>
 #include "Cell.h"
-#include "Food.h"
+#include "CellRoles.h"
+#include "FoodStore.h"
+#include "HierarchicalGrid.h"
+#include "NeighbourLists.h"
 #include <atomic>
 #include <list>
-
-using baseObjMatrix = std::vector<std::vector< std::vector<std::shared_ptr<BaseObj> >>>;
+#include <functional>
 
 class Environment final
 {
 public:
 	~Environment();
 	static Environment& getInstance();
-	static sf::Vector2i getCollisionSectorCoords(std::shared_ptr<BaseObj> o);
 
-	void configure(sf::Vector2f envSize = {2000,1000}, bool randomFill = false);
+	// seed = 0 - new random seed
+	void configure(sf::Vector2f envSize = {2000,1000}, bool randomFill = false, uint32_t seed = 0);
 	void configure(std::string formattedEnvString);
 	void clear();
-	void update();
+
+	// advances simulation by one step - does not depend on window, mouse or user tools
+	void update(const float& deltaTime);
 	void draw(sf::RenderWindow & window);
 
+	// called at the beginning of every step, before new cells join - apps attach their tools here (e.g. auto feeder)
+	void setStepHook(std::function<void()> hook);
+	// set by app that draws environment - simulation itself does not need textures
+	void setBackgroundTexture(const sf::Texture* texture);
+
+	// duration of currently simulated step - use it in all role-functions
+	const float& getDeltaTime();
+
+	// values passed to role-functions in current step - filled at the beginning of update
+	const TickContext& getTickContext();
+	// context with current values - for role-functions called outside of step (e.g. by user tools)
+	TickContext makeTickContext();
+
 	void pauseSimulation();
 	void startSimualtion();
 	std::atomic_bool& getIsSimulationActive();
 
+	// same seed and same initial state give the same simulation run
+	uint32_t getSeed();
+	void setSeed(uint32_t seed);
+
 	std::atomic<double>& getTemperature();
 	void setTemperature(const double&);
 
 	std::atomic<double>& getRadiation();
 	void setRadiation(const double&);
 
+	// cells keep their closest food / cell and search for new ones every n steps
+	// (or at once when target was eaten, died or left radar range) - 1 = search in every step
+	std::atomic<int>& getTargetSearchInterval();
+	void setTargetSearchInterval(const int&);
+
 	sf::Vector2f getSize();
+
+	// what happens to cells reaching border of environment
+	enum class BoundaryMode
+	{
+		// cell bounces off the border - heading is mirrored
+		Reflect,
+		// toroidal world - cell leaving on one side enters on the other, distances and searches wrap too
+		Wrap
+	};
+
+	BoundaryMode getBoundaryMode();
+	void setBoundaryMode(BoundaryMode mode);
+
+	// vector from one point to another - the shortest one across borders in Wrap mode
+	sf::Vector2f getDisplacement(const sf::Vector2f& from, const sf::Vector2f& to);
+
+	// calls query(position) for position and, in Wrap mode, for its copies shifted by environment size
+	// that are closer than range to environment - searches in sectors see objects across borders
+	template <typename Query>
+	void forEachWrappedImage(const sf::Vector2f& position, double range, Query query);
+
 	int getAliveCellsCount();
 	int getFoodCount();
 
 	std::shared_ptr<Cell> getCellAtPosition(const sf::Vector2f&);
 
-	const std::vector<std::shared_ptr<Food>>& getFoodsVector();
+	FoodStore& getFoodStore();
 	std::vector<std::shared_ptr<Cell>>& getCellsVector();
 	std::vector<std::shared_ptr<Cell>>& getNewCellsVector();
-	const std::vector<std::shared_ptr<Food>>& getNewFoodsVector();
 
-	baseObjMatrix& getCellCollisionSectors();
-	baseObjMatrix& getFoodCollisionSectors();
+	// rebuilt every step before sense phase - indices point to cells / food vectors
+	HierarchicalGrid<Cell>& getCellCollisionSectors();
+	HierarchicalGrid<Food>& getFoodCollisionSectors();
+
+	// several levels of collision sectors (matched to query range) or one level of tuned sector size
+	// does not change simulation results - only speed
+	void setHierarchicalGrid(bool enabled);
+	bool isHierarchicalGrid();
+
+	// every n steps cells vector and CellStore rows are sorted by Morton code of collision sector,
+	// so cells close in space are updated one after another and read nearby memory - 0 = insertion order
+	int getCellsSortInterval();
+	void setCellsSortInterval(int interval);
+
+	// contacts of cells between neighbour list rebuilds
+	NeighbourLists& getNeighbourLists();
 
 	// inserts new cell to environment
 	void insertNewCell(std::shared_ptr<Cell>);
 
-	// inserts new food to environment
-	void insertNewFood(std::shared_ptr<Food>);
+	// inserts new food to environment - it is visible for cells from next step
+	// (called in parallel act chunk - food is inserted after the chunks)
+	void insertNewFood(const Food& f);
+
+	// removes food immediately - O(1)
+	void removeFood(FoodHandle f);
+
+	// called by Cell::kill - cell is moved out of cells vector at the end of step
+	// (called in parallel act chunk - cell is registered after the chunks)
+	void registerKilledCell(Cell* c);
 
 	// returns string that can be used to save whole environment to file 
 	std::string getSaveString();
 
 	bool isObjInEnvironmentBounds(BaseObj::Ptr o, float expectedSize = 0);
+	bool isObjInEnvironmentBounds(const sf::Vector2f& position, float size);
 
 	void modifyValueFromString(std::string valueName, std::string value);
 	void modifyValueFromVector(std::string valueName, const std::vector<std::string>& value);
 private:
-	// used to determine collision sector size
+	// collision sector size until population is known
 	// value = cell max radius*2 (diameter) + margin
-	static constexpr int sectorSize = 50 * 2 + 30; 
+	static constexpr float defaultSectorSize = 50 * 2 + 30;
+	static constexpr float minSectorSize = 32;
+	static constexpr float maxSectorSize = 512;
+	// steps between checks of cell size and radar range distributions
+	static constexpr int sectorTuningInterval = 600;
+	// sorting is off until it is measured to pay off on large populations (--sort-interval)
+	static constexpr int defaultCellsSortInterval = 0;
 
 	Environment();
 	Environment(Environment const&) = delete;
 	Environment& operator=(Environment const&) = delete;
 
 	void updateBackground();
+	// colour added to background and living cells - red when hot, blue when cold, green for radiation
+	sf::Color getEnvironmentTint();
 	void sterilizeEnvironment();
+	void configureCollisionSectors();
+	// chooses sector size and levels from current population - grids are reconfigured only if statistics drifted
+	void tuneCollisionSectors();
+	void sortCellsBySectors();
+	sf::Vector2f wrapDisplacement(sf::Vector2f displacement);
+
+	// fills archetypeGroups with not freezed cells - keeps order of given vector in every group
+	void groupByArchetype(const std::vector<std::shared_ptr<Cell>>& cellsToGroup);
+	// every role-function is called in one loop over all cells of archetype
+	void senseByArchetype();
+	// act roles between sequential ones (see CellRoles::isSequentialRole) run in parallel chunks of group
+	void actByArchetype();
+	void actInChunks(const std::vector<Cell*>& group, int archetype, const std::vector<CellRoles::RolePtr>& roles, size_t firstRole, size_t lastRole);
 
 	std::vector<std::shared_ptr<Cell>> cells;
 	std::vector<std::shared_ptr<Cell>> deadCells;
 	std::vector<std::shared_ptr<Cell>> newCells;
-	std::vector<std::shared_ptr<Food>> food;
-	std::vector<std::shared_ptr<Food>> newFood;
-	baseObjMatrix cellCollisionSectors;
-	baseObjMatrix foodCollisionSectors;
+	FoodStore food;
+	// one shape for all food records
+	sf::CircleShape foodShape;
+	HierarchicalGrid<Cell> cellCollisionSectors;
+	HierarchicalGrid<Food> foodCollisionSectors;
+	bool hierarchicalGrid;
+	BoundaryMode boundaryMode;
+	// base level of collision sectors, levels above it cover long radar ranges
+	float sectorSize;
+	int coarseLevels;
+	int stepsToSectorTuning;
+	bool sectorsTuned;
+	NeighbourLists neighbourLists;
+	int cellsSortInterval;
+	int stepsToCellsSort;
+	// Morton code and position in cells vector - reused between sorts
+	std::vector<std::pair<uint32_t, uint32_t>> cellsSortKeys;
+	std::vector<std::shared_ptr<Cell>> sortedCells;
+	std::vector<size_t> sortedRows;
+
+	// objects removed since last cleanup - vectors without removals are not swept at the end of step
+	std::vector<Cell*> killedCells;
+	std::vector<Cell*> removedDeadCells;
+
+	// cells of every archetype (index = archetype id) - inner vectors are reused between steps
+	std::vector<std::vector<Cell*>> archetypeGroups;
+
+	// killed cell or food dropped by it - made by role-function in parallel act chunk
+	struct ActIntent
+	{
+		// nullptr - food insertion
+		Cell* killed;
+		Food food;
+	};
+	// intents of every role-function run by chunk - applied by role, then by chunk, which gives
+	// the same order as sequential loops over group (thread count does not change results)
+	struct ActChunk
+	{
+		std::vector<std::vector<ActIntent>> roleIntents;
+	};
+	// fixed chunk size - chunks do not depend on number of threads
+	static constexpr size_t actChunkSize = 256;
+	std::vector<ActChunk> actChunks;
+	// intents of role-function running on this thread - nullptr outside of parallel act chunks
+	static thread_local std::vector<ActIntent>* actIntents;
+
+	// unordered pairs of cells in contact from sense phase - fight and mating are resolved once per pair
+	std::vector<std::pair<Cell*, Cell*>> contactPairs;
 
 	sf::RectangleShape environmentBackground;
 	sf::Color backgroundDefaultColor;
 
+	float deltaTime;
+	TickContext tickContext;
+
+	uint32_t seed;
+	// next id of cell random stream
+	uint64_t nextStreamId;
+
 	std::atomic<double> _temperature;
 	std::atomic<double> _radiation;
+	std::atomic<int> _targetSearchInterval;
 	std::atomic<int> _aliveCellsCount;
 	std::atomic<int> _foodCount;
 	std::atomic_bool _clearEnvironment;
 	std::atomic_bool _simulationActive;
-	bool _wasAutofeederActive;
+
+	std::function<void()> stepHook;
 
 	struct VarAbbrv final
 	{
@@ -95,6 +238,10 @@ private:
 		static constexpr const char *const radiation = "Radiation";
 		static constexpr const char *const isSimualtionActive = "isSimulationActive";
 		static constexpr const char *const envSize = "EnvSize";
+		static constexpr const char *const seed = "Seed";
+		static constexpr const char *const targetSearchInterval = "TargetSearchInterval";
+		static constexpr const char *const neighbourSkin = "NeighbourSkin";
+		static constexpr const char *const boundaryMode = "BoundaryMode";
 
 	private:
 		VarAbbrv() = delete;
@@ -102,4 +249,30 @@ private:
 		VarAbbrv& operator=(const VarAbbrv&) = delete;
 		virtual ~VarAbbrv() = 0;
 	};
-};
\ No newline at end of file
+};
+
+inline sf::Vector2f Environment::getDisplacement(const sf::Vector2f & from, const sf::Vector2f & to)
+{
+	if (boundaryMode != BoundaryMode::Wrap) return to - from;
+	return wrapDisplacement(to - from);
+}
+
+template<typename Query>
+inline void Environment::forEachWrappedImage(const sf::Vector2f & position, double range, Query query)
+{
+	query(position);
+	if (boundaryMode != BoundaryMode::Wrap) return;
+
+	// shifts by -1, 0, 1 environment sizes on each axis - (0, 0) is the position itself
+	const auto size = getSize();
+	const int minX = position.x < range ? -1 : 0, maxX = position.x > size.x - range ? 1 : 0;
+	const int minY = position.y < range ? -1 : 0, maxY = position.y > size.y - range ? 1 : 0;
+	for (int x = minX; x <= maxX; ++x)
+	{
+		for (int y = minY; y <= maxY; ++y)
+		{
+			if (x != 0 || y != 0)
+				query(sf::Vector2f(position.x - x * size.x, position.y - y * size.y));
+		}
+	}
+}
@@ -1,13 +1,15 @@
 #include "Food.h"
 #include "RegexPattern.h"
 #include "Logger.h"
-#include "CellSimApp.h"
 #include <sstream>
 #include <regex>
 
-Food::Food(float size, sf::Vector2f position, sf::Color color, float maxSize) : BaseObj(size, position, color)
+Food::Food() : Food(0, { 0,0 }, sf::Color::Transparent, 0)
+{
+}
+
+Food::Food(float size, sf::Vector2f position, sf::Color color, float maxSize) : position(position), size(size), maxSize(maxSize), color(color)
 {
-	this->maxSize = maxSize;
 }
 
 Food::Food(std::string formattedFoodString) : Food(0, { 0,0 }, sf::Color::Transparent, 0)
@@ -64,13 +66,11 @@ void Food::modifyValueFromString(std::string valueName, std::string value)
 	//Logger::log("Setting '" + valueName + "' to " + value);
 	auto& v = valueName;
 
-	if (v == VarAbbrv::currentRotation)			this->setRotation(std::stod(value));
-	else if (v == VarAbbrv::currentSize)		this->setSize((std::stod(value)));
+	// rotation and delete mark are kept only for compatibility with older saves
+	if (v == VarAbbrv::currentRotation)			return;
+	else if (v == VarAbbrv::markedToDelete)		return;
+	else if (v == VarAbbrv::currentSize)		this->size = std::stod(value);
 	else if (v == VarAbbrv::maxSize)			this->maxSize = std::stod(value);
-	else if (v == BaseObj::VarAbbrv::markedToDelete)
-	{
-		if (std::stod(value)) this->markToDelete();
-	}
 	else Logger::log(std::string("Unknown food var name '" + v + "' with value '" + value + "'!"));
 }
 
@@ -86,7 +86,7 @@ void Food::modifyValueFromVector(std::string valueName, const std::vector<std::s
 			Logger::log("Wrong values count for " + std::string(VarAbbrv::currentPosition) + ": " + std::to_string(values.size()) + ".");
 			return;
 		}
-		this->setPosition(sf::Vector2f(std::stod(values[0]), std::stod(values[1])));
+		this->position = sf::Vector2f(std::stod(values[0]), std::stod(values[1]));
 	}
 	else if (v == VarAbbrv::color)
 	{
@@ -95,45 +95,32 @@ void Food::modifyValueFromVector(std::string valueName, const std::vector<std::s
 			Logger::log("Wrong values count for " + std::string(VarAbbrv::color) + ": " + std::to_string(values.size()) + ".");
 			return;
 		}
-		this->setBaseColor(sf::Color(std::stod(values[0]), std::stod(values[1]), std::stod(values[2]), std::stod(values[3])), true);
+		this->color = sf::Color(std::stod(values[0]), std::stod(values[1]), std::stod(values[2]), std::stod(values[3]));
 	}
 }
 
-Food::~Food()
+void Food::update(float deltaTime)
 {
-}
-
-void Food::update()
-{
-	auto currentSize = shape.getRadius();
-	if (currentSize < maxSize)
+	if (size < maxSize)
 	{
-		currentSize += 0.07 * CellSimApp::getInstance().getDeltaTime();
-		if (currentSize > maxSize) currentSize = maxSize;
-		setSize(currentSize);
+		size += growthSpeed * deltaTime;
+		if (size > maxSize) size = maxSize;
 	}
 }
 
-std::string Food::getSaveString()
+std::string Food::getSaveString() const
 {
 	std::ostringstream result;
 
 	result << "FOOD-> " <<
-		VarAbbrv::currentRotation << ":" << this->getRotation() << " " <<
-		VarAbbrv::currentPosition << ":{" << this->getPosition().x << ", " << this->getPosition().y << "} " <<
-		VarAbbrv::currentSize << ":" << this->getSize() << " " <<
+		VarAbbrv::currentPosition << ":{" << this->position.x << ", " << this->position.y << "} " <<
+		VarAbbrv::currentSize << ":" << this->size << " " <<
 		VarAbbrv::maxSize << ":" << this->maxSize << " " <<
 		VarAbbrv::color << ":{" <<
-		static_cast<int>(this->getBaseColor().r) << ", " <<
-		static_cast<int>(this->getBaseColor().g) << ", " <<
-		static_cast<int>(this->getBaseColor().b) << ", " <<
-		static_cast<int>(this->getBaseColor().a) << "} " <<
-		VarAbbrv::markedToDelete << ":" << this->isMarkedToDelete() << " ";
+		static_cast<int>(this->color.r) << ", " <<
+		static_cast<int>(this->color.g) << ", " <<
+		static_cast<int>(this->color.b) << ", " <<
+		static_cast<int>(this->color.a) << "} ";
 
 	return result.str();
 }
-
-float Food::getMaxSize()
-{
-	return maxSize;
-}
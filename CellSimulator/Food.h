@@ -1,36 +1,47 @@
 #pragma once
 #include <SFML/Graphics.hpp>
-#include "BaseObj.h"
-#include <memory>
+#include <string>
+#include <vector>
 
-class Food : public BaseObj
+// Single food item - packed record kept by FoodStore (no shape, no shared_ptr).
+// Drawn by environment with one shared shape.
+struct Food
 {
-public:
-	template <typename ... T>
-	static std::shared_ptr<Food> create(T ... values);
+	Food();
+	Food(float size, sf::Vector2f position, sf::Color color, float maxSize);
+	Food(std::string formattedFoodString);
 
-	~Food();
+	sf::Vector2f position;
+	float size;
+	float maxSize;
+	sf::Color color;
 
-	void update();
+	// size added in one unit of time
+	static constexpr double growthSpeed = 0.07;
 
-	std::string getSaveString();
+	// grows food up to maxSize
+	void update(float deltaTime);
 
-	float getMaxSize();
+	std::string getSaveString() const;
 
 private:
-	Food(float size, sf::Vector2f position, sf::Color color, float maxSize);
-	Food(std::string formattedFoodString);
-
 	void modifyValueFromString(std::string valueName, std::string value);
 	void modifyValueFromVector(std::string valueName, const std::vector<std::string>& value);
 
-	float maxSize;
+	// abbreviation used to save food to file
+	struct VarAbbrv final
+	{
+		static constexpr const char *const currentRotation = "Rt";
+		static constexpr const char *const currentPosition = "Ps";
+		static constexpr const char *const color = "C";
+		static constexpr const char *const currentSize = "Si";
+		static constexpr const char *const maxSize = "MS";
+		static constexpr const char *const markedToDelete = "TD";
+
+	private:
+		VarAbbrv() = delete;
+		VarAbbrv(const VarAbbrv&) = delete;
+		VarAbbrv& operator=(const VarAbbrv&) = delete;
+		virtual ~VarAbbrv() = 0;
+	};
 };
-
-template<typename ...T>
-inline std::shared_ptr<Food> Food::create(T ... values)
-{
-	auto result = std::make_shared<Food>(Food(values ...));
-	result->setSelfPtr(result);
-	return result;
-}
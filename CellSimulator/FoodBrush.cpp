@@ -3,7 +3,7 @@
 #include "MessagesManager.h"
 #include "Environment.h"
 #include "Food.h"
-#include "CellSimApp.h"
+#include "SimulationClock.h"
 
 #define PI 3.14159265
 
@@ -17,20 +17,19 @@ void FoodBrush::update()
 {
 	if (isActive)
 	{
-		elapsedTime += CellSimApp::getInstance().getDeltaTime();
+		auto deltaTime = SimulationClock::getInstance().getFrameDeltaTime();
+		elapsedTime += deltaTime;
 		brush.setPosition(CellSimMouse::getPosition());
 		if (CellSimMouse::isLeftPressed() && elapsedTime > delay)
 		{
 			elapsedTime = 0;
 			float radius = brush.getRadius();
-			Logger::log((CellSimApp::getInstance().getDeltaTime() * 3.14 * (radius / 2)) * 0.002 * hardness);
-			for (int i = 0; i < (CellSimApp::getInstance().getDeltaTime() * 3.14 * (radius / 2)) * 0.002 * hardness; i++)
+			for (int i = 0; i < (deltaTime * 3.14 * (radius / 2)) * 0.002 * hardness; i++)
 			{
 				double angle = randomReal(0, 360);
-				std::shared_ptr<Food> food;
 				sf::Vector2f position(CellSimMouse::getPosition().x + randomReal(-radius * std::cos(angle * PI / 180), radius * std::cos(angle * PI / 180)), CellSimMouse::getPosition().y + randomReal(-radius * std::sin(angle * PI / 180), radius * std::sin(angle * PI / 180)));
-				food = Food::create(2, position, sf::Color(0, randomInt(128, 255), randomInt(0, 64)), randomInt(3, 10));
-				if (Environment::getInstance().isObjInEnvironmentBounds(food, food->getMaxSize()))
+				Food food(2, position, sf::Color(0, randomInt(128, 255), randomInt(0, 64)), randomInt(3, 10));
+				if (Environment::getInstance().isObjInEnvironmentBounds(food.position, food.maxSize))
 				{
 					Environment::getInstance().insertNewFood(food);
 				}
@@ -27,7 +27,7 @@ public:
 private:
 	bool isActive;
 	int delay;
-	int elapsedTime;
+	float elapsedTime;
 	double hardness;
 	sf::CircleShape brush;
 };
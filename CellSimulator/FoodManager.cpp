@@ -22,7 +22,7 @@ FoodManager & FoodManager::getInstance()
 void FoodManager::generateFood(sf::Vector2f size, int amount)
 {
 	for (int i = 0; i < amount; i++) {
-		auto food = Food::create(
+		Food food(
 			0,
 			sf::Vector2f(randomInt(40, static_cast<int>(Environment::getInstance().getSize().x - 40)), randomInt(40, static_cast<int>(Environment::getInstance().getSize().y - 40))),
 			sf::Color(0, randomInt(128, 255), randomInt(0, 64)),
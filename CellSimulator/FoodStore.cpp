@@ -0,0 +1,110 @@
+#include "FoodStore.h"
+#include "Logger.h"
+
+FoodStore::FoodStore()
+{
+}
+
+FoodStore::~FoodStore()
+{
+}
+
+FoodHandle FoodStore::insert(const Food & food)
+{
+	uint32_t slot;
+	if (!freeSlots.empty())
+	{
+		slot = freeSlots.front();
+		freeSlots.pop_front();
+	}
+	else
+	{
+		if (slots.size() > FoodHandle::indexMask)
+		{
+			Logger::log("Food limit reached.");
+			return FoodHandle();
+		}
+		slot = static_cast<uint32_t>(slots.size());
+		slots.push_back(Slot{ 0, 0 });
+	}
+
+	slots[slot].record = static_cast<uint32_t>(records.size());
+	records.push_back(food);
+	recordSlots.push_back(slot);
+
+	return FoodHandle(slot, slots[slot].generation);
+}
+
+void FoodStore::remove(FoodHandle handle)
+{
+	if (get(handle) == nullptr) return;
+
+	auto slot = handle.getIndex();
+	auto record = slots[slot].record;
+	auto last = static_cast<uint32_t>(records.size() - 1);
+
+	if (record != last)
+	{
+		records[record] = records[last];
+		recordSlots[record] = recordSlots[last];
+		slots[recordSlots[record]].record = record;
+	}
+	records.pop_back();
+	recordSlots.pop_back();
+
+	slots[slot].generation = FoodHandle::nextGeneration(slot, slots[slot].generation);
+	freeSlots.push_back(slot);
+}
+
+void FoodStore::clear()
+{
+	// slots keep generations - old handles stay invalid
+	for (auto slot : recordSlots)
+	{
+		slots[slot].generation = FoodHandle::nextGeneration(slot, slots[slot].generation);
+		freeSlots.push_back(slot);
+	}
+	records.clear();
+	recordSlots.clear();
+}
+
+Food * FoodStore::get(FoodHandle handle)
+{
+	if (!handle.isValid()) return nullptr;
+
+	auto slot = handle.getIndex();
+	if (slot >= slots.size() || slots[slot].generation != handle.getGeneration())
+		return nullptr;
+	return &records[slots[slot].record];
+}
+
+size_t FoodStore::size() const
+{
+	return records.size();
+}
+
+bool FoodStore::empty() const
+{
+	return records.empty();
+}
+
+Food & FoodStore::operator[](size_t index)
+{
+	return records[index];
+}
+
+FoodHandle FoodStore::getHandle(size_t index) const
+{
+	auto slot = recordSlots[index];
+	return FoodHandle(slot, slots[slot].generation);
+}
+
+std::vector<Food>::iterator FoodStore::begin()
+{
+	return records.begin();
+}
+
+std::vector<Food>::iterator FoodStore::end()
+{
+	return records.end();
+}
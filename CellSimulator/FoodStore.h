@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include "Food.h"
+#include "Handle.h"
+
+using FoodHandle = Handle<Food>;
+
+// Pool of food records.
+// Records are packed in one dense vector - removed record is replaced by the last one (swap-remove),
+// so loops over food never skip holes. Handles go through slot table and stay valid when records move;
+// slots of removed food are reused (FIFO free list).
+//
+// Dense indices change after remove() - collision grid is rebuilt from them at the beginning of every step.
+class FoodStore final
+{
+public:
+	FoodStore();
+	~FoodStore();
+
+	FoodHandle insert(const Food& food);
+
+	// O(1) - ignores handles of already removed food
+	void remove(FoodHandle handle);
+
+	void clear();
+
+	// nullptr if food was removed
+	Food* get(FoodHandle handle);
+
+	size_t size() const;
+	bool empty() const;
+
+	// dense access
+	Food& operator[](size_t index);
+	FoodHandle getHandle(size_t index) const;
+
+	std::vector<Food>::iterator begin();
+	std::vector<Food>::iterator end();
+
+private:
+	struct Slot
+	{
+		uint32_t record;
+		uint32_t generation;
+	};
+
+	std::vector<Food> records;
+	// slot of every record - parallel to records
+	std::vector<uint32_t> recordSlots;
+
+	std::vector<Slot> slots;
+	// FIFO - released slot is reused after all other free slots
+	std::deque<uint32_t> freeSlots;
+};
@@ -12,6 +12,7 @@
 #include "CellFactory.h"
 #include "DoubleToString.h"
 #include "FoodBrush.h"
+#include "SimulationClock.h"
 #include <regex>
 #include "RegexPattern.h"
 
@@ -203,7 +204,7 @@ std::shared_ptr<tgui::MenuBar> GUIManager::createMenuBar(std::shared_ptr<tgui::G
 	MenuBar->addMenuItem("Simulation", "New");
 	MenuBar->connectMenuItem("Simulation", "New", [this, gui]() {newWindow->setPosition(window->getSize().x / 2 - 180, window->getSize().y / 2 - 80); saveWindow->destroy(); loadWindow->destroy(); gui->add(newWindow, "new"); });
 	MenuBar->addMenuItem("Simulation", "New Random");
-	MenuBar->connectMenuItem("Simulation", "New Random", []() {Environment::getInstance().configure(sf::Vector2f(randomReal(0.5, 3.5) * 1000, randomReal(0.5, 3.5) * 1000), true); });
+	MenuBar->connectMenuItem("Simulation", "New Random", []() {Environment::getInstance().configure(sf::Vector2f(randomReal(0.5, 3.5) * 1000, randomReal(0.5, 3.5) * 1000), true); SimulationClock::getInstance().reset(); });
 	MenuBar->addMenuItem("Simulation", "Clear");
 	MenuBar->connectMenuItem("Simulation", "Clear", []() {Environment::getInstance().clear(); });
 	MenuBar->addMenuItem("Simulation", "Save");
@@ -219,7 +220,10 @@ std::shared_ptr<tgui::MenuBar> GUIManager::createMenuBar(std::shared_ptr<tgui::G
 	confirmN->connect("pressed", [=]()
 	{
 		if (std::stod(widthN->getText().toAnsiString()) > 149 && std::stod(widthN->getText().toAnsiString()) < 5001 && std::stod(heightN->getText().toAnsiString()) > 149 && std::stod(heightN->getText().toAnsiString()) < 5001)
+		{
 			Environment::getInstance().configure(sf::Vector2f(std::stod(widthN->getText().toAnsiString()), std::stod(heightN->getText().toAnsiString())));
+			SimulationClock::getInstance().reset();
+		}
 		else
 			MessagesManager::getInstance().append("Invalid size - must be in range of 150-5000");
 		std::cout << std::stod(widthN->getText().toAnsiString());
@@ -323,6 +327,9 @@ GUIManager & GUIManager::getInstance()
 void GUIManager::configure(std::shared_ptr<sf::RenderWindow> window)
 {
 	MessagesManager::getInstance().configure();
+	messageText.setFont(CellSimApp::getInstance().getFont());
+	messageText.setCharacterSize(messageSize);
+	messageText.setFillColor(sf::Color::White);
 
 	this->window = window;
 	mainGui = std::make_shared<tgui::Gui>(*window);
@@ -909,7 +916,7 @@ void GUIManager::configure(std::shared_ptr<sf::RenderWindow> window)
 
 			if (std::all_of(checkResults.begin(), checkResults.end(), [&](auto r) {return r == true; }))
 			{
-				CellSelectionTool::getInstance().getSelectedCell()->getGenes() = selectedCellPtr->getGenes();
+				CellSelectionTool::getInstance().getSelectedCell()->setGenes(selectedCellPtr->getGenes());
 			}
 		}
 
@@ -970,6 +977,7 @@ void GUIManager::configure(std::shared_ptr<sf::RenderWindow> window)
 		if (CellSelectionTool::getInstance().getSelectedCell() != nullptr)
 		{
 			CellSelectionTool::getInstance().getSelectedCell()->getGenes().type = 2;
+			CellSelectionTool::getInstance().getSelectedCell()->invalidateColors();
 		}
 	});
 
@@ -986,6 +994,7 @@ void GUIManager::configure(std::shared_ptr<sf::RenderWindow> window)
 		if (CellSelectionTool::getInstance().getSelectedCell() != nullptr)
 		{
 			CellSelectionTool::getInstance().getSelectedCell()->getGenes().type = 0;
+			CellSelectionTool::getInstance().getSelectedCell()->invalidateColors();
 		}
 	});
 
@@ -1002,6 +1011,7 @@ void GUIManager::configure(std::shared_ptr<sf::RenderWindow> window)
 		if (CellSelectionTool::getInstance().getSelectedCell() != nullptr)
 		{
 			CellSelectionTool::getInstance().getSelectedCell()->getGenes().type = 1;
+			CellSelectionTool::getInstance().getSelectedCell()->invalidateColors();
 		}
 	});
 
@@ -1184,7 +1194,7 @@ void GUIManager::update()
 		speedM->setDefaultText(doubleToString(cell->getGenes().maxSpeed.get(), 2));
 		//age
 		updateValues(ageValTT, ageVal, "Min: " + doubleToString(cell->getGenes().maxAge.getMin(), 2) + "\nMax: " + doubleToString(cell->getGenes().maxAge.get(), 2),
-			doubleToString(cell->age, 2), cell->getGenes().maxAge.get() * 100, cell->getGenes().maxAge.getMin() * 100, cell->age * 100);
+			doubleToString(cell->getAge(), 2), cell->getGenes().maxAge.get() * 100, cell->getGenes().maxAge.getMin() * 100, cell->getAge() * 100);
 		ageM->setDefaultText(doubleToString(cell->getGenes().maxAge.get(), 2));
 		//horniness
 		updateValues(horninessValTT, horninessVal, "Min: " + doubleToString(cell->getHorniness().getMin(), 2) + "\nMax: " + doubleToString(cell->getHorniness().getMax(), 2),
@@ -1276,8 +1286,21 @@ void GUIManager::draw()
 			window->draw(*selectedCellPtr);
 	}
 
-	MessagesManager::getInstance().draw(window);
+	drawMessages();
 
 	window->setView(defaultView);
 }
 
+void GUIManager::drawMessages()
+{
+	int i = 0;
+	for (auto& m : MessagesManager::getInstance().getMessages())
+	{
+		// std::get to get text from tuple
+		messageText.setString(std::get<1>(m));
+		messageText.setPosition({ messagesZeroPoint.x, messagesZeroPoint.y + messageOffset + i * messageOffset });
+		window->draw(messageText);
+		++i;
+	}
+}
+
@@ -37,6 +37,13 @@ private:
 
 	sf::RectangleShape background;
 
+	// messages of MessagesManager - one text object drawn at each message position
+	void drawMessages();
+	sf::Text messageText;
+	const sf::Vector2f messagesZeroPoint{ 400.0, 0.0 };
+	static constexpr int messageOffset = 25; //px
+	static constexpr int messageSize = 20; //px
+
 	void setVisible(std::vector<std::shared_ptr<tgui::Widget>> widgets, int enable);
 	void updateValues(std::shared_ptr<tgui::Label> ValTT, std::shared_ptr<tgui::ProgressBar> Val, sf::String setTextTT, sf::String setText, int max, int min, int val);
 
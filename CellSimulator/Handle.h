@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+
+// 32-bit generational handle - 20 bits of slot index, 12 bits of slot generation.
+// Owner changes generation when slot is released, so handle of removed object resolves to nothing
+// and references kept between steps are checked without shared_ptr refcounting.
+// Generations wrap around - owners reuse free slots first in, first out, so a stale handle would have to
+// outlive 4096 * (free slots) insertions to match again (kept handles are refreshed much sooner).
+template <typename T>
+class Handle final
+{
+public:
+	static constexpr uint32_t indexBits = 20;
+	static constexpr uint32_t indexMask = (1u << indexBits) - 1;
+	static constexpr uint32_t generationMask = (1u << (32 - indexBits)) - 1;
+
+	Handle() : value(invalidValue) {}
+	Handle(uint32_t index, uint32_t generation) : value((generation << indexBits) | index) {}
+
+	bool isValid() const { return value != invalidValue; }
+
+	uint32_t getIndex() const { return value & indexMask; }
+	uint32_t getGeneration() const { return value >> indexBits; }
+
+	bool operator==(const Handle& h) const { return value == h.value; }
+	bool operator!=(const Handle& h) const { return value != h.value; }
+
+	// generation of released slot - skips the one that would give invalid handle
+	static uint32_t nextGeneration(uint32_t index, uint32_t generation)
+	{
+		generation = (generation + 1) & generationMask;
+		if (Handle(index, generation).value == invalidValue) generation = 0;
+		return generation;
+	}
+
+private:
+	static constexpr uint32_t invalidValue = 0xFFFFFFFF;
+
+	uint32_t value;
+};
@@ -0,0 +1,204 @@
+#include "HeadlessApp.h"
+#include "Environment.h"
+#include "AutoFeederTool.h"
+#include "FilesManager.h"
+#include "Logger.h"
+#include "SimulationClock.h"
+#include "WorkerPool.h"
+#include "PackedScan.h"
+
+HeadlessApp & HeadlessApp::getInstance()
+{
+	static HeadlessApp instance;
+	return instance;
+}
+
+HeadlessApp::HeadlessApp() : environmentSize(3000, 1500), seed(0), threads(0), steps(10000), logInterval(1000), feederThreshold(0), targetSearchInterval(0), neighbourSkin(-1), fixedGrid(false), cellsSortInterval(-1), wrap(false), deltaTime(1.6667f)
+{
+}
+
+HeadlessApp::~HeadlessApp()
+{
+}
+
+bool HeadlessApp::configure(int argc, char ** argv)
+{
+	try
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			bool hasValue = i + 1 < argc;
+
+			if (arg == "--help")
+			{
+				printUsage();
+				return false;
+			}
+			else if (arg == "--load" && hasValue)		loadPath = argv[++i];
+			else if (arg == "--save" && hasValue)		savePath = argv[++i];
+			else if (arg == "--steps" && hasValue)		steps = std::stoll(argv[++i]);
+			else if (arg == "--dt" && hasValue)			deltaTime = std::stof(argv[++i]);
+			else if (arg == "--log" && hasValue)		logInterval = std::stoi(argv[++i]);
+			else if (arg == "--feeder" && hasValue)		feederThreshold = std::stoi(argv[++i]);
+			else if (arg == "--seed" && hasValue)		seed = std::stoul(argv[++i]);
+			else if (arg == "--threads" && hasValue)	threads = std::stoi(argv[++i]);
+			else if (arg == "--search-interval" && hasValue)	targetSearchInterval = std::stoi(argv[++i]);
+			else if (arg == "--skin" && hasValue)		neighbourSkin = std::stof(argv[++i]);
+			else if (arg == "--fixed-grid")				fixedGrid = true;
+			else if (arg == "--wrap")					wrap = true;
+			else if (arg == "--sort-interval" && hasValue)	cellsSortInterval = std::stoi(argv[++i]);
+			else if (arg == "--size" && i + 2 < argc)
+			{
+				environmentSize.x = std::stof(argv[++i]);
+				environmentSize.y = std::stof(argv[++i]);
+			}
+			else
+			{
+				Logger::log("Unknown or incomplete argument '" + arg + "'.");
+				printUsage();
+				return false;
+			}
+		}
+	}
+	catch (std::exception e)
+	{
+		Logger::log(e.what());
+		printUsage();
+		return false;
+	}
+
+	if (deltaTime <= 0 || steps < 0 || threads < 0 || targetSearchInterval < 0 || environmentSize.x <= 0 || environmentSize.y <= 0)
+	{
+		Logger::log("Wrong argument value.");
+		printUsage();
+		return false;
+	}
+	return true;
+}
+
+int HeadlessApp::run()
+{
+	auto& environment = Environment::getInstance();
+	auto& simulationClock = SimulationClock::getInstance();
+	simulationClock.configure(deltaTime);
+	WorkerPool::getInstance().configure(threads);
+	environment.setHierarchicalGrid(!fixedGrid);
+	if (cellsSortInterval >= 0)
+		environment.setCellsSortInterval(cellsSortInterval);
+
+	if (!loadEnvironment())
+		return 1;
+
+	if (targetSearchInterval > 0)
+		environment.setTargetSearchInterval(targetSearchInterval);
+	if (neighbourSkin >= 0)
+		environment.getNeighbourLists().setSkin(neighbourSkin);
+	if (wrap)
+		environment.setBoundaryMode(Environment::BoundaryMode::Wrap);
+
+	if (feederThreshold > 0)
+	{
+		AutoFeederTool::getInstance().setMaxThresholdValue(feederThreshold);
+		AutoFeederTool::getInstance().setIsActive(true);
+		environment.setStepHook([]() { AutoFeederTool::getInstance().update(); });
+	}
+	environment.startSimualtion();
+
+	Logger::log("Headless simulation started - seed: " + std::to_string(environment.getSeed()) + " threads: " + std::to_string(WorkerPool::getInstance().getThreadsCount()) + " scan: " + getPackedScanVersion() + " grid: " + (fixedGrid ? "fixed" : "hierarchical") + " sort interval: " + std::to_string(environment.getCellsSortInterval()) + " boundary: " + (environment.getBoundaryMode() == Environment::BoundaryMode::Wrap ? "wrap" : "reflect") + " dt: " + std::to_string(deltaTime) + " steps: " + (steps == 0 ? std::string("unlimited") : std::to_string(steps)));
+
+	sf::Clock totalClock;
+	sf::Clock logClock;
+
+	long long step = 0;
+	for (; steps == 0 || step < steps; ++step)
+	{
+		environment.update(simulationClock.getTickSize());
+
+		if (logInterval > 0 && (step + 1) % logInterval == 0)
+		{
+			logStats(step + 1, logClock.restart());
+		}
+
+		if (environment.getCellsVector().empty() && environment.getNewCellsVector().empty())
+		{
+			Logger::log("Population died out after " + std::to_string(step + 1) + " steps.");
+			++step;
+			break;
+		}
+	}
+
+	auto total = totalClock.getElapsedTime().asSeconds();
+	Logger::log("Simulated " + std::to_string(step) + " steps in " + std::to_string(total) + " s (" + std::to_string(total > 0 ? step / total : 0) + " steps/s).");
+
+	saveEnvironment();
+	return 0;
+}
+
+void HeadlessApp::printUsage()
+{
+	Logger::log("Usage: cellsim_headless [options]\n"
+		"  --load <file>        load environment save (random environment is generated otherwise)\n"
+		"  --size <w> <h>       size of generated environment (default 3000 1500)\n"
+		"  --seed <value>       seed of generated environment, 0 = random (loaded environment uses seed from save)\n"
+		"  --steps <n>          number of simulation steps, 0 = until population dies out (default 10000)\n"
+		"  --dt <value>         simulation step duration (default 1.6667 - 60 FPS equivalent)\n"
+		"  --feeder <value>     enables auto feeder with given threshold\n"
+		"  --threads <n>        number of simulation threads, 0 = one per CPU core (default 0)\n"
+		"  --search-interval <n> cells search for new closest food / cell every n steps (default 1 or value from save)\n"
+		"  --skin <value>       margin of cell neighbour lists - bigger = rarer and slower rebuilds (default 20 or value from save)\n"
+		"  --fixed-grid         single level of collision sectors instead of hierarchical grid (same results, for benchmarks)\n"
+		"  --wrap               toroidal world - cells leaving on one side enter on the other (default reflect or value from save)\n"
+		"  --sort-interval <n>  sort cells by position every n steps, 0 = never - compare cache misses of both with perf stat (default 0)\n"
+		"  --log <n>            log statistics every n steps, 0 = disabled (default 1000)\n"
+		"  --save <file>        save environment to file after simulation");
+}
+
+bool HeadlessApp::loadEnvironment()
+{
+	if (loadPath.empty())
+	{
+		Environment::getInstance().configure(environmentSize, true, seed);
+		return true;
+	}
+
+	try
+	{
+		Environment::getInstance().configure(FilesManager::getInstance().readFile(loadPath));
+	}
+	catch (std::exception e)
+	{
+		Logger::log(e.what());
+		return false;
+	}
+	return true;
+}
+
+void HeadlessApp::saveEnvironment()
+{
+	if (savePath.empty())
+		return;
+
+	try
+	{
+		FilesManager::getInstance().writeFile(savePath, Environment::getInstance().getSaveString());
+		Logger::log("Environment saved to " + savePath + ".");
+	}
+	catch (std::exception e)
+	{
+		Logger::log(e.what());
+	}
+}
+
+void HeadlessApp::logStats(long long step, const sf::Time & elapsed)
+{
+	auto seconds = elapsed.asSeconds();
+	Logger::log("Step " + std::to_string(step) +
+		"   cells: " + std::to_string(Environment::getInstance().getAliveCellsCount()) +
+		"   food: " + std::to_string(Environment::getInstance().getFoodCount()) +
+		"   steps/s: " + std::to_string(seconds > 0 ? logInterval / seconds : 0));
+
+	auto& stats = Environment::getInstance().getNeighbourLists().getStats();
+	Logger::log("Neighbour lists rebuilt " + std::to_string(stats.rebuilds) + " times in " + std::to_string(stats.steps) + " steps" +
+		"   (drift: " + std::to_string(stats.driftRebuilds) + ", new objects: " + std::to_string(stats.freshRebuilds) + ")");
+}
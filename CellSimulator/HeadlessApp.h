@@ -0,0 +1,55 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <string>
+#include <cstdint>
+
+// Runs simulation without window, GUI and user tools.
+// Steps are computed one after another as fast as CPU allows (no framerate limit).
+class HeadlessApp final
+{
+public:
+	static HeadlessApp& getInstance();
+
+	~HeadlessApp();
+
+	/// \returns false if command line arguments are invalid
+	bool configure(int argc, char** argv);
+
+	/// \returns process exit code
+	int run();
+
+	void printUsage();
+
+private:
+	HeadlessApp();
+	HeadlessApp(const HeadlessApp&) = delete;
+	HeadlessApp& operator=(const HeadlessApp&) = delete;
+
+	bool loadEnvironment();
+	void saveEnvironment();
+	void logStats(long long step, const sf::Time& elapsed);
+
+	std::string loadPath;
+	std::string savePath;
+
+	sf::Vector2f environmentSize;
+	uint32_t seed;
+	int threads;
+
+	// 0 = run until population dies out
+	long long steps;
+	int logInterval;
+	int feederThreshold;
+	// 0 = value from loaded environment
+	int targetSearchInterval;
+	// < 0 = value from loaded environment
+	float neighbourSkin;
+	bool fixedGrid;
+	// < 0 = default of environment
+	int cellsSortInterval;
+	// false = boundary mode from loaded environment
+	bool wrap;
+
+	// 1.6667 equals one frame of GUI app limited to 60 FPS
+	float deltaTime;
+};
@@ -0,0 +1,9 @@
+#include "HeadlessApp.h"
+
+int main(int argc, char** argv)
+{
+	if (!HeadlessApp::getInstance().configure(argc, argv))
+		return 1;
+
+	return HeadlessApp::getInstance().run();
+}
@@ -0,0 +1,198 @@
+#pragma once
+#include "CollisionGrid.h"
+#include <atomic>
+#include <memory>
+
+// Collision grids of the same area with sector sizes growing by 2 (levels).
+// Queries pick the level matching their range - short range queries and queries in crowded areas
+// scan few small sectors, long range queries in empty areas visit few big ones instead of many small ones.
+// Results of NearestSearch / PackedNearestSearch do not depend on chosen level.
+//
+// Base level is rebuilt in every step, other levels only if enough queries asked for them since previous
+// rebuild (until then base level is used) - a level is not rebuilt for a few queries in a world full of objects.
+template <typename T>
+class HierarchicalGrid final
+{
+public:
+	HierarchicalGrid();
+
+	// levels with sector sizes baseSectorSize * 2^(level - baseLevel) - baseLevel finer levels below base
+	// levelsCount = 1 - single fixed grid
+	void configure(sf::Vector2f areaSize, float baseSectorSize, int levelsCount = 4, int baseLevel = 1);
+	void clear();
+
+	// levels - bit per level from takeRequestedLevels, base level is always rebuilt
+	void rebuild(const std::vector<std::shared_ptr<T>>& objects, uint32_t levels);
+
+	template <typename PositionFunction, typename RadiusFunction>
+	void rebuild(size_t count, PositionFunction position, RadiusFunction radius, uint32_t levels);
+
+	// level for query of given range around position in this grid and other grid with the same levels
+	// (fused search) - built in both grids; query is counted as request for matching level of this grid
+	template <typename U>
+	int selectLevel(const sf::Vector2f& position, double range, const HierarchicalGrid<U>& other) const;
+
+	// levels requested by queries since last call that are worth rebuilding for objectsCount objects
+	// (in all grids sharing the levels) - resets requests
+	uint32_t takeRequestedLevels(size_t objectsCount);
+
+	const CollisionGrid<T>& getLevel(int level) const;
+	const CollisionGrid<T>& getBaseLevel() const;
+	int getLevelsCount() const;
+
+	// false - level is stale
+	bool isLevelBuilt(int level) const;
+
+	// radius of the largest object from last rebuild
+	float getMaxRadius() const;
+
+private:
+	// objects in 3x3 sectors around query position - more means nearest object is found in first rings,
+	// so query is moved to finer level
+	static constexpr size_t crowdedCount = 4;
+
+	// objects (and sectors) inserted to a level cost about as much as one query saves on matching level
+	static constexpr size_t objectsPerQuery = 16;
+
+	// finest level where query of given range checks at most two rings of sectors around its own
+	int selectLevel(double range) const;
+
+	std::vector<CollisionGrid<T>> levels;
+	std::vector<float> sectorSizes;
+	int baseLevel;
+
+	// bit per level
+	uint32_t builtLevels;
+	// queries per level since takeRequestedLevels
+	std::unique_ptr<std::atomic<uint32_t>[]> requests;
+};
+
+template<typename T>
+inline HierarchicalGrid<T>::HierarchicalGrid() : baseLevel(0), builtLevels(1), requests(new std::atomic<uint32_t>[1])
+{
+	levels.resize(1);
+	sectorSizes.assign(1, 1);
+	requests[0] = 0;
+}
+
+template<typename T>
+inline void HierarchicalGrid<T>::configure(sf::Vector2f areaSize, float baseSectorSize, int levelsCount, int baseLevel)
+{
+	levelsCount = std::min(std::max(levelsCount, 1), 32);
+	this->baseLevel = std::min(std::max(baseLevel, 0), levelsCount - 1);
+
+	levels.resize(levelsCount);
+	sectorSizes.resize(levelsCount);
+	for (int level = 0; level < levelsCount; ++level)
+	{
+		sectorSizes[level] = baseSectorSize * std::pow(2.0f, static_cast<float>(level - this->baseLevel));
+		levels[level].configure(areaSize, sectorSizes[level]);
+	}
+
+	builtLevels = 1u << this->baseLevel;
+	requests.reset(new std::atomic<uint32_t>[levelsCount]);
+	for (int level = 0; level < levelsCount; ++level)
+		requests[level] = 0;
+}
+
+template<typename T>
+inline void HierarchicalGrid<T>::clear()
+{
+	for (auto& level : levels)
+		level.clear();
+}
+
+template<typename T>
+inline void HierarchicalGrid<T>::rebuild(const std::vector<std::shared_ptr<T>>& objects, uint32_t levels)
+{
+	rebuild(objects.size(),
+		[&objects](size_t i) { return objects[i]->getPosition(); },
+		[&objects](size_t i) { return objects[i]->getSize(); },
+		levels);
+}
+
+template<typename T>
+template<typename PositionFunction, typename RadiusFunction>
+inline void HierarchicalGrid<T>::rebuild(size_t count, PositionFunction position, RadiusFunction radius, uint32_t levels)
+{
+	builtLevels = levels | (1u << baseLevel);
+
+	for (int level = 0; level < getLevelsCount(); ++level)
+	{
+		if (isLevelBuilt(level))
+			this->levels[level].rebuild(count, position, radius);
+	}
+}
+
+template<typename T>
+template<typename U>
+inline int HierarchicalGrid<T>::selectLevel(const sf::Vector2f& position, double range, const HierarchicalGrid<U>& other) const
+{
+	auto& base = getBaseLevel();
+	auto& otherBase = other.getBaseLevel();
+
+	int level = selectLevel(range);
+	while (level > 0)
+	{
+		auto halfBlock = 1.5 * sectorSizes[level];
+		if (base.countInRange(position, halfBlock) + otherBase.countInRange(position, halfBlock) <= crowdedCount) break;
+		--level;
+	}
+
+	// counted also when built - keeps level for next step
+	requests[level].fetch_add(1, std::memory_order_relaxed);
+	return isLevelBuilt(level) && other.isLevelBuilt(level) ? level : baseLevel;
+}
+
+template<typename T>
+inline uint32_t HierarchicalGrid<T>::takeRequestedLevels(size_t objectsCount)
+{
+	uint32_t result = 1u << baseLevel;
+	for (int level = 0; level < getLevelsCount(); ++level)
+	{
+		auto sectors = levels[level].getSectorsCount();
+		size_t cost = objectsCount + static_cast<size_t>(sectors.x) * sectors.y;
+		if (requests[level].exchange(0, std::memory_order_relaxed) * objectsPerQuery >= cost)
+			result |= 1u << level;
+	}
+	return result;
+}
+
+template<typename T>
+inline int HierarchicalGrid<T>::selectLevel(double range) const
+{
+	int level = 0;
+	while (level + 1 < getLevelsCount() && 2 * sectorSizes[level] < range)
+		++level;
+	return level;
+}
+
+template<typename T>
+inline const CollisionGrid<T>& HierarchicalGrid<T>::getLevel(int level) const
+{
+	return levels[level];
+}
+
+template<typename T>
+inline const CollisionGrid<T>& HierarchicalGrid<T>::getBaseLevel() const
+{
+	return levels[baseLevel];
+}
+
+template<typename T>
+inline int HierarchicalGrid<T>::getLevelsCount() const
+{
+	return static_cast<int>(levels.size());
+}
+
+template<typename T>
+inline bool HierarchicalGrid<T>::isLevelBuilt(int level) const
+{
+	return (builtLevels & (1u << level)) != 0;
+}
+
+template<typename T>
+inline float HierarchicalGrid<T>::getMaxRadius() const
+{
+	return getBaseLevel().getMaxRadius();
+}
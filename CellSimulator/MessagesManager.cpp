@@ -1,6 +1,5 @@
 #include "MessagesManager.h"
 #include "Logger.h"
-#include "CellSimApp.h"
 #include <tuple>
 
 
@@ -13,8 +12,8 @@ MessagesManager & MessagesManager::getInstance()
 
 void MessagesManager::configure()
 {
+	configured = true;
 	messages.clear();
-	zeroPoint = { 400.0, 0.0 };
 
 	clock.restart();
 }
@@ -35,25 +34,23 @@ void MessagesManager::update()
 	}
 }
 
-void MessagesManager::draw(std::shared_ptr<sf::RenderWindow> window)
+void MessagesManager::append(std::string s)
 {
-	for (auto& m : messages)
-		// std::get to get text from tuple
-		window->draw(std::get<1>(m));
+	if (!configured)
+	{
+		Logger::log(s);
+		return;
+	}
+
+	messages.push_front(std::tuple<sf::Time, std::string>(clock.getElapsedTime(), s));
 }
 
-void MessagesManager::append(std::string s)
+const std::list<std::tuple<sf::Time, std::string>>& MessagesManager::getMessages()
 {
-	sf::Text t;
-	t.setFont(CellSimApp::getInstance().getFont());
-	t.setCharacterSize(messageSize);
-	t.setFillColor(sf::Color::White);
-	t.setString(s);
-	messages.push_front(std::tuple<sf::Time, sf::Text>(clock.getElapsedTime(), t));
-	positionMessages();
+	return messages;
 }
 
-MessagesManager::MessagesManager()
+MessagesManager::MessagesManager() : configured(false)
 {
 }
 
@@ -61,14 +58,3 @@ MessagesManager::MessagesManager()
 MessagesManager::~MessagesManager()
 {
 }
-
-void MessagesManager::positionMessages()
-{
-	int i = 0;
-	auto it = messages.begin();
-	for (; it != messages.end(); ++it, ++i)
-	{
-		// std::get to get text from tuple
-		std::get<1>(*it).setPosition({ zeroPoint.x, zeroPoint.y + messageOffset + i * messageOffset });
-	}
-}
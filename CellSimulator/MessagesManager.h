@@ -1,38 +1,38 @@
 #pragma once
 #include <list>
-#include <SFML/Graphics.hpp>
+#include <SFML/System.hpp>
+#include <string>
 #include <tuple>
 
+// Keeps short messages for user - text is drawn by GUI (GUIManager), so core does not need fonts.
 class MessagesManager
 {
 public:
 
 	static MessagesManager& getInstance();
 
+	// messages are logged instead of kept for display until configured (e.g. headless mode)
 	void configure();
 
 	void update();
 
-	void draw(std::shared_ptr<sf::RenderWindow> window);
-
 	void append(std::string s);
 
+	// newest message first
+	const std::list<std::tuple<sf::Time, std::string>>& getMessages();
+
 private:
 	MessagesManager();
 	~MessagesManager();
 	MessagesManager(const MessagesManager&) = delete;
 	MessagesManager& operator=(const MessagesManager&) = delete;
 
-	void positionMessages();
-
-	std::list<std::tuple<sf::Time, sf::Text>> messages;
+	std::list<std::tuple<sf::Time, std::string>> messages;
 
-	sf::Vector2f zeroPoint;
+	bool configured;
 
 	sf::Clock clock;
 
-	static constexpr int messageOffset = 25; //px
-	static constexpr int messageSize = 20; //px
 	static constexpr int secBeforeMessageDelete = 5; 
 };
 
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstdint>
+
+// Morton (Z-order) code - bits of x and y interleaved (x on even bits).
+// Points sorted by code of their grid sector are close in memory when they are close in space:
+// every aligned block of 2x2, 4x4, 8x8... sectors is one continuous range of codes.
+inline uint32_t spreadMortonBits(uint32_t v)
+{
+	v &= 0x0000FFFF;
+	v = (v | (v << 8)) & 0x00FF00FF;
+	v = (v | (v << 4)) & 0x0F0F0F0F;
+	v = (v | (v << 2)) & 0x33333333;
+	v = (v | (v << 1)) & 0x55555555;
+	return v;
+}
+
+inline uint32_t mortonCode(uint16_t x, uint16_t y)
+{
+	return spreadMortonBits(x) | (spreadMortonBits(y) << 1);
+}
@@ -0,0 +1,111 @@
+#include "NeighbourLists.h"
+#include "Cell.h"
+#include "Environment.h"
+#include <cmath>
+#include <algorithm>
+
+NeighbourLists::NeighbourLists() : skin(defaultSkin), generation(1), rebuildStep(false), invalidated(true), foodGrowthSinceRebuild(0)
+{
+}
+
+NeighbourLists::~NeighbourLists()
+{
+}
+
+void NeighbourLists::update(const std::vector<std::shared_ptr<Cell>>& cells, float foodGrowth)
+{
+	++stats.steps;
+	foodGrowthSinceRebuild += foodGrowth;
+
+	// cells without origin in current generation were added after rebuild
+	freshCells.clear();
+	auto& environment = Environment::getInstance();
+	float maxDrift = 0;
+	for (auto& cell : cells)
+	{
+		auto& neighbours = cell->getNeighbours();
+		if (neighbours.originGeneration != generation || neighbours.owner != cell->getHandle())
+		{
+			freshCells.push_back(cell.get());
+			continue;
+		}
+
+		// shortest move - cell wrapped around border of toroidal world moved only a little
+		auto move = environment.getDisplacement(neighbours.origin, cell->getPosition());
+		auto drift = std::sqrt(move.x*move.x + move.y*move.y) + std::max(0.0f, cell->getSize() - neighbours.originSize);
+		maxDrift = std::max(maxDrift, drift);
+	}
+
+	// two objects can get closer by sum of their drifts - both have to stay below half of skin
+	bool drifted = 2 * maxDrift > skin || maxDrift + foodGrowthSinceRebuild > skin;
+	bool tooManyFresh = freshCells.size() + freshFood.size() > freshLimit;
+
+	rebuildStep = invalidated || drifted || tooManyFresh;
+	if (!rebuildStep) return;
+
+	++stats.rebuilds;
+	if (drifted) ++stats.driftRebuilds;
+	else if (tooManyFresh) ++stats.freshRebuilds;
+
+	++generation;
+	invalidated = false;
+	foodGrowthSinceRebuild = 0;
+	freshCells.clear();
+	freshFood.clear();
+
+	// lists themselves are built by cells in sense phase
+	for (auto& cell : cells)
+	{
+		auto& neighbours = cell->getNeighbours();
+		neighbours.origin = cell->getPosition();
+		neighbours.originSize = cell->getSize();
+		neighbours.owner = cell->getHandle();
+		neighbours.originGeneration = generation;
+	}
+}
+
+void NeighbourLists::invalidate()
+{
+	invalidated = true;
+}
+
+void NeighbourLists::insertFood(FoodHandle food)
+{
+	freshFood.push_back(food);
+}
+
+bool NeighbourLists::isRebuildStep() const
+{
+	return rebuildStep;
+}
+
+uint32_t NeighbourLists::getGeneration() const
+{
+	return generation;
+}
+
+const std::vector<Cell*>& NeighbourLists::getFreshCells() const
+{
+	return freshCells;
+}
+
+const std::vector<FoodHandle>& NeighbourLists::getFreshFood() const
+{
+	return freshFood;
+}
+
+float NeighbourLists::getSkin() const
+{
+	return skin;
+}
+
+void NeighbourLists::setSkin(float skin)
+{
+	this->skin = std::max(skin, 0.0f);
+	invalidate();
+}
+
+const NeighbourLists::Stats & NeighbourLists::getStats() const
+{
+	return stats;
+}
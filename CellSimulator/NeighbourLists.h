@@ -0,0 +1,92 @@
+#pragma once
+#include <SFML/System.hpp>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "Handle.h"
+
+class Cell;
+struct Food;
+
+using CellHandle = Handle<Cell>;
+using FoodHandle = Handle<Food>;
+
+// Neighbour list (Verlet list) of one cell - kept by the cell, managed by NeighbourLists.
+struct CellNeighbours
+{
+	// objects closer than contact distance + skin when list was built
+	std::vector<CellHandle> cells;
+	std::vector<FoodHandle> food;
+
+	// position and size of cell at last rebuild - drift is measured from them
+	sf::Vector2f origin;
+	float originSize = 0;
+
+	// cell and generation for which origin was recorded / list was built - copies of cell never match
+	CellHandle owner;
+	uint32_t originGeneration = 0;
+	uint32_t listGeneration = 0;
+};
+
+// Verlet lists for contact detection.
+// On rebuild every cell collects objects closer than contact distance + skin (in sense phase, with radar query).
+// Between rebuilds contacts are tested only against that list and against objects created after rebuild (fresh objects).
+// Lists are rebuilt when any cell moved or grew by more than half of the skin (food growth included),
+// when there are too many fresh objects or when cells were moved outside of simulation (invalidate).
+class NeighbourLists final
+{
+public:
+	struct Stats
+	{
+		long long steps = 0;
+		long long rebuilds = 0;
+		// rebuilds caused by drift / by fresh objects
+		long long driftRebuilds = 0;
+		long long freshRebuilds = 0;
+	};
+
+	NeighbourLists();
+	~NeighbourLists();
+
+	// called before sense phase - decides if lists are rebuilt in this step
+	// foodGrowth - max growth of food in this step
+	void update(const std::vector<std::shared_ptr<Cell>>& cells, float foodGrowth);
+
+	// forces rebuild in next step
+	void invalidate();
+
+	// food inserted after last rebuild
+	void insertFood(FoodHandle food);
+
+	bool isRebuildStep() const;
+	uint32_t getGeneration() const;
+
+	// cells of current step which are not in lists of other cells
+	const std::vector<Cell*>& getFreshCells() const;
+	const std::vector<FoodHandle>& getFreshFood() const;
+
+	// margin used by new environments and saves without skin
+	static constexpr float defaultSkin = 20;
+
+	float getSkin() const;
+	void setSkin(float skin);
+
+	const Stats& getStats() const;
+
+private:
+	// more fresh objects make scan of fresh vectors slower than rebuild
+	static constexpr size_t freshLimit = 32;
+
+	float skin;
+	uint32_t generation;
+	bool rebuildStep;
+	bool invalidated;
+
+	// max food growth since last rebuild
+	float foodGrowthSinceRebuild;
+
+	std::vector<Cell*> freshCells;
+	std::vector<FoodHandle> freshFood;
+
+	Stats stats;
+};
@@ -0,0 +1,248 @@
+#include "PackedScan.h"
+#include <limits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PACKED_SCAN_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(PACKED_SCAN_X86) && (defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__))
+#define PACKED_SCAN_SSE2
+#endif
+
+// msvc accepts avx intrinsics in any function, gcc and clang need target attribute
+#if defined(PACKED_SCAN_X86) && defined(_MSC_VER)
+#define PACKED_SCAN_AVX2
+#define TARGET_AVX2
+#elif defined(PACKED_SCAN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PACKED_SCAN_AVX2
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace
+{
+	using ScanFunction = PackedScanResult(*)(const float*, const float*, const float*, size_t, float, float, float, float, uint32_t*);
+
+	// objects [begin, count) - also used for tails of vector versions
+	void scanRange(const float* x, const float* y, const float* r, size_t begin, size_t count,
+		float px, float py, float radius, float margin, uint32_t* contacts, PackedScanResult& result)
+	{
+		for (size_t i = begin; i < count; ++i)
+		{
+			float dx = px - x[i];
+			float dy = py - y[i];
+			float distance = dx * dx + dy * dy;
+
+			if (result.nearest < 0 || distance < result.nearestDistance)
+			{
+				result.nearest = static_cast<int>(i);
+				result.nearestDistance = distance;
+			}
+
+			if (contacts != nullptr)
+			{
+				float sizes = radius + r[i] + margin;
+				if (distance <= sizes * sizes)
+					contacts[result.contactsCount++] = static_cast<uint32_t>(i);
+			}
+		}
+	}
+
+	// nearest of lanes - equal distances are resolved by position, so the first object wins as in scalar loop
+	void reduceLanes(const float* distances, const int32_t* positions, int lanes, PackedScanResult& result)
+	{
+		for (int lane = 0; lane < lanes; ++lane)
+		{
+			if (positions[lane] < 0) continue;
+			if (result.nearest < 0 || distances[lane] < result.nearestDistance ||
+				(distances[lane] == result.nearestDistance && positions[lane] < result.nearest))
+			{
+				result.nearest = positions[lane];
+				result.nearestDistance = distances[lane];
+			}
+		}
+	}
+
+	void appendContacts(int mask, size_t first, int lanes, uint32_t* contacts, PackedScanResult& result)
+	{
+		for (int lane = 0; lane < lanes; ++lane)
+		{
+			if (mask & (1 << lane))
+				contacts[result.contactsCount++] = static_cast<uint32_t>(first + lane);
+		}
+	}
+
+#ifndef PACKED_SCAN_SSE2
+	PackedScanResult scanScalar(const float* x, const float* y, const float* r, size_t count,
+		float px, float py, float radius, float margin, uint32_t* contacts)
+	{
+		PackedScanResult result{ -1, 0, 0 };
+		scanRange(x, y, r, 0, count, px, py, radius, margin, contacts, result);
+		return result;
+	}
+#endif
+
+#ifdef PACKED_SCAN_SSE2
+	PackedScanResult scanSse2(const float* x, const float* y, const float* r, size_t count,
+		float px, float py, float radius, float margin, uint32_t* contacts)
+	{
+		PackedScanResult result{ -1, 0, 0 };
+		const size_t vectorCount = count / 4 * 4;
+
+		if (vectorCount > 0)
+		{
+			const __m128 vx = _mm_set1_ps(px);
+			const __m128 vy = _mm_set1_ps(py);
+			const __m128 vradius = _mm_set1_ps(radius);
+			const __m128 vmargin = _mm_set1_ps(margin);
+			const __m128i step = _mm_set1_epi32(4);
+
+			__m128 best = _mm_set1_ps(std::numeric_limits<float>::infinity());
+			__m128i bestPositions = _mm_set1_epi32(-1);
+			__m128i positions = _mm_setr_epi32(0, 1, 2, 3);
+
+			for (size_t i = 0; i < vectorCount; i += 4)
+			{
+				__m128 dx = _mm_sub_ps(vx, _mm_loadu_ps(x + i));
+				__m128 dy = _mm_sub_ps(vy, _mm_loadu_ps(y + i));
+				__m128 distance = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+
+				__m128 closer = _mm_cmplt_ps(distance, best);
+				best = _mm_or_ps(_mm_and_ps(closer, distance), _mm_andnot_ps(closer, best));
+				__m128i closerMask = _mm_castps_si128(closer);
+				bestPositions = _mm_or_si128(_mm_and_si128(closerMask, positions), _mm_andnot_si128(closerMask, bestPositions));
+
+				if (contacts != nullptr)
+				{
+					__m128 sizes = _mm_add_ps(_mm_add_ps(vradius, _mm_loadu_ps(r + i)), vmargin);
+					int mask = _mm_movemask_ps(_mm_cmple_ps(distance, _mm_mul_ps(sizes, sizes)));
+					appendContacts(mask, i, 4, contacts, result);
+				}
+
+				positions = _mm_add_epi32(positions, step);
+			}
+
+			float distances[4];
+			int32_t lanePositions[4];
+			_mm_storeu_ps(distances, best);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(lanePositions), bestPositions);
+			reduceLanes(distances, lanePositions, 4, result);
+		}
+
+		scanRange(x, y, r, vectorCount, count, px, py, radius, margin, contacts, result);
+		return result;
+	}
+#endif
+
+#ifdef PACKED_SCAN_AVX2
+	TARGET_AVX2 PackedScanResult scanAvx2(const float* x, const float* y, const float* r, size_t count,
+		float px, float py, float radius, float margin, uint32_t* contacts)
+	{
+		PackedScanResult result{ -1, 0, 0 };
+		const size_t vectorCount = count / 8 * 8;
+
+		if (vectorCount > 0)
+		{
+			const __m256 vx = _mm256_set1_ps(px);
+			const __m256 vy = _mm256_set1_ps(py);
+			const __m256 vradius = _mm256_set1_ps(radius);
+			const __m256 vmargin = _mm256_set1_ps(margin);
+			const __m256i step = _mm256_set1_epi32(8);
+
+			__m256 best = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+			__m256i bestPositions = _mm256_set1_epi32(-1);
+			__m256i positions = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+			for (size_t i = 0; i < vectorCount; i += 8)
+			{
+				// separate mul and add - no fma, same rounding as scalar version
+				__m256 dx = _mm256_sub_ps(vx, _mm256_loadu_ps(x + i));
+				__m256 dy = _mm256_sub_ps(vy, _mm256_loadu_ps(y + i));
+				__m256 distance = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+				__m256 closer = _mm256_cmp_ps(distance, best, _CMP_LT_OQ);
+				best = _mm256_blendv_ps(best, distance, closer);
+				bestPositions = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestPositions), _mm256_castsi256_ps(positions), closer));
+
+				if (contacts != nullptr)
+				{
+					__m256 sizes = _mm256_add_ps(_mm256_add_ps(vradius, _mm256_loadu_ps(r + i)), vmargin);
+					int mask = _mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_mul_ps(sizes, sizes), _CMP_LE_OQ));
+					appendContacts(mask, i, 8, contacts, result);
+				}
+
+				positions = _mm256_add_epi32(positions, step);
+			}
+
+			float distances[8];
+			int32_t lanePositions[8];
+			_mm256_storeu_ps(distances, best);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanePositions), bestPositions);
+			_mm256_zeroupper();
+			reduceLanes(distances, lanePositions, 8, result);
+		}
+
+		scanRange(x, y, r, vectorCount, count, px, py, radius, margin, contacts, result);
+		return result;
+	}
+
+	bool isAvx2Supported()
+	{
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+
+		// avx registers have to be enabled by os (osxsave + xgetbv)
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+#endif
+
+	struct SelectedScan
+	{
+		ScanFunction function;
+		const char* name;
+	};
+
+	SelectedScan selectScan()
+	{
+#ifdef PACKED_SCAN_AVX2
+		if (isAvx2Supported()) return SelectedScan{ scanAvx2, "AVX2" };
+#endif
+#ifdef PACKED_SCAN_SSE2
+		return SelectedScan{ scanSse2, "SSE2" };
+#else
+		return SelectedScan{ scanScalar, "scalar" };
+#endif
+	}
+
+	const SelectedScan& getSelectedScan()
+	{
+		static const SelectedScan selected = selectScan();
+		return selected;
+	}
+}
+
+PackedScanResult scanPacked(const float * x, const float * y, const float * r, size_t count,
+	float px, float py, float radius, float margin, uint32_t * contacts)
+{
+	return getSelectedScan().function(x, y, r, count, px, py, radius, margin, contacts);
+}
+
+const char * getPackedScanVersion()
+{
+	return getSelectedScan().name;
+}
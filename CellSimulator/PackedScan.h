@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Nearest object and contacts over packed coordinates (separate x, y and radius arrays).
+// AVX2, SSE2 or scalar version is selected once by CPU features - all of them do the same float
+// operations in the same order, so results do not depend on the machine.
+
+struct PackedScanResult
+{
+	// position of nearest object in arrays (first one of equal distances), -1 if there are no objects
+	int nearest;
+	// squared distance to nearest object
+	float nearestDistance;
+	// number of positions written to contacts
+	size_t contactsCount;
+};
+
+// squared distance to object i = (px - x[i])^2 + (py - y[i])^2
+// object i is in contact if its squared distance <= (radius + r[i] + margin)^2
+// contacts - positions of objects in contact (space for count values), nullptr = contacts are not needed
+PackedScanResult scanPacked(const float* x, const float* y, const float* r, size_t count,
+	float px, float py, float radius, float margin, uint32_t* contacts);
+
+// name of selected version - for logs
+const char* getPackedScanVersion();
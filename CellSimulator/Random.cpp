@@ -1,27 +1,109 @@
 #include"Random.h"
 
-int randomInt(int a, int b)
+namespace
+{
+	thread_local RandomStream* boundStream = nullptr;
+
+	uint64_t splitMix64(uint64_t& x)
+	{
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	inline uint64_t rotl(const uint64_t x, int k)
+	{
+		return (x << k) | (x >> (64 - k));
+	}
+}
+
+RandomStream::RandomStream(uint64_t seed, uint64_t streamId)
+{
+	this->seed(seed, streamId);
+}
+
+void RandomStream::seed(uint64_t seed, uint64_t streamId)
+{
+	// mix stream id into seed, then expand it with splitmix - neighbouring ids give unrelated states
+	uint64_t x = seed ^ (streamId * 0xD1B54A32D192ED03ull);
+	x = splitMix64(x) ^ streamId;
+	for (auto& s : state)
+	{
+		s = splitMix64(x);
+	}
+}
+
+uint64_t RandomStream::next()
+{
+	const uint64_t result = rotl(state[1] * 5, 7) * 9;
+	const uint64_t t = state[1] << 17;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+
+	state[2] ^= t;
+	state[3] = rotl(state[3], 45);
+
+	return result;
+}
+
+int RandomStream::nextInt(int a, int b)
 {
 	if (a > b)
 	{
 		std::swap(a, b);
 	}
-	static std::random_device rd;
-	static std::mt19937 gen(rd());
-	std::uniform_int_distribution<> dis(a, b);
-
-	return dis(gen);
+	// multiply-shift range reduction - no division, no distribution object
+	const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(b) - a) + 1;
+	return static_cast<int>(a + static_cast<int64_t>(((next() >> 32) * range) >> 32));
 }
 
-double randomReal(double a, double b)
+double RandomStream::nextReal(double a, double b)
 {
 	if (a > b)
 	{
 		std::swap(a, b);
 	}
+	// 53 random bits -> <0, 1)
+	return a + (b - a) * ((next() >> 11) * (1.0 / 9007199254740992.0));
+}
+
+RandomStream & defaultRandomStream()
+{
+	static RandomStream stream(randomSeed());
+	return stream;
+}
+
+RandomStream & activeRandomStream()
+{
+	return boundStream != nullptr ? *boundStream : defaultRandomStream();
+}
+
+RandomStreamScope::RandomStreamScope(RandomStream & stream) : previous(boundStream)
+{
+	boundStream = &stream;
+}
+
+RandomStreamScope::~RandomStreamScope()
+{
+	boundStream = previous;
+}
+
+uint32_t randomSeed()
+{
 	static std::random_device rd;
-	static std::mt19937 gen(rd());
-	std::uniform_real_distribution<> dis(a, b);
+	return rd();
+}
 
-	return dis(gen);
+int randomInt(int a, int b)
+{
+	return activeRandomStream().nextInt(a, b);
+}
+
+double randomReal(double a, double b)
+{
+	return activeRandomStream().nextReal(a, b);
 }
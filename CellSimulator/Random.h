@@ -1,5 +1,49 @@
 #pragma once
-#include<random>
+#include <random>
+#include <cstdint>
+
+// xoshiro256** generator.
+// Every stream is seeded from (seed, stream id) pair, so streams created from the same seed are independent and reproducible.
+class RandomStream final
+{
+public:
+	RandomStream(uint64_t seed = 0, uint64_t streamId = 0);
+
+	void seed(uint64_t seed, uint64_t streamId = 0);
+
+	uint64_t next();
+
+	// <a, b>
+	int nextInt(int a, int b);
+
+	// <a, b)
+	double nextReal(double a, double b);
+
+private:
+	uint64_t state[4];
+};
+
+// Stream used by randomInt and randomReal in current thread.
+// Default stream is used when no stream is bound to the thread.
+RandomStream& activeRandomStream();
+RandomStream& defaultRandomStream();
+
+// Binds stream to current thread for scope lifetime.
+class RandomStreamScope final
+{
+public:
+	explicit RandomStreamScope(RandomStream& stream);
+	~RandomStreamScope();
+
+private:
+	RandomStreamScope(const RandomStreamScope&) = delete;
+	RandomStreamScope& operator=(const RandomStreamScope&) = delete;
+
+	RandomStream* previous;
+};
+
+// new random seed (not reproducible)
+uint32_t randomSeed();
 
 int randomInt(int a, int b);
 
@@ -2,6 +2,7 @@
 #include "FilesManager.h"
 #include "Environment.h"
 #include "MessagesManager.h"
+#include "SimulationClock.h"
 #include <Windows.h>
 
 SaveManager::SaveManager()
@@ -76,6 +77,7 @@ void SaveManager::readEnvironmentFromFile(std::string filename)
 	{
 		saveString = FilesManager::getInstance().readFile(fullpath);
 		Environment::getInstance().configure(saveString);
+		SimulationClock::getInstance().reset();
 	}
 	catch (std::exception e)
 	{
@@ -0,0 +1,116 @@
+#include "SimulationClock.h"
+#include <algorithm>
+#include <cmath>
+
+SimulationClock::SimulationClock() : tickSize(1.6667f), maxStepsPerFrame(5), timeScale(1), accumulator(0), discardFrame(false), frameDeltaTime(0), elapsedTime(0), stepsCount(0)
+{
+}
+
+SimulationClock::~SimulationClock()
+{
+}
+
+SimulationClock & SimulationClock::getInstance()
+{
+	static SimulationClock instance;
+	return instance;
+}
+
+void SimulationClock::configure(float tickSize, int maxStepsPerFrame)
+{
+	setTickSize(tickSize);
+	setMaxStepsPerFrame(maxStepsPerFrame);
+	reset();
+}
+
+int SimulationClock::advance(float frameDeltaTime)
+{
+	if (discardFrame)
+	{
+		// frame was spent loading or configuring - not simulated time
+		discardFrame = false;
+		frameDeltaTime = 0;
+	}
+
+	accumulator += std::max(frameDeltaTime, 0.0f) * timeScale;
+
+	// fast forward needs proportionally more steps per frame
+	int maxSteps = maxStepsPerFrame * std::max(1, static_cast<int>(std::ceil(timeScale)));
+
+	int steps = static_cast<int>(accumulator / tickSize);
+	if (steps > maxSteps)
+	{
+		// cannot catch up - simulation runs slower than real time instead of piling up steps
+		steps = maxSteps;
+		accumulator = 0;
+	}
+	else
+	{
+		accumulator -= steps * tickSize;
+	}
+
+	this->frameDeltaTime = steps * tickSize;
+	return steps;
+}
+
+void SimulationClock::step(float deltaTime)
+{
+	elapsedTime += deltaTime;
+	++stepsCount;
+}
+
+void SimulationClock::reset()
+{
+	accumulator = 0;
+	frameDeltaTime = 0;
+	discardFrame = true;
+}
+
+float SimulationClock::getTickSize()
+{
+	return tickSize;
+}
+
+void SimulationClock::setTickSize(float tickSize)
+{
+	if (tickSize > 0)
+		this->tickSize = tickSize;
+}
+
+int SimulationClock::getMaxStepsPerFrame()
+{
+	return maxStepsPerFrame;
+}
+
+void SimulationClock::setMaxStepsPerFrame(int steps)
+{
+	if (steps > 0)
+		this->maxStepsPerFrame = steps;
+}
+
+float SimulationClock::getTimeScale()
+{
+	return timeScale;
+}
+
+void SimulationClock::setTimeScale(float scale)
+{
+	if (scale > 0)
+		this->timeScale = scale;
+}
+
+float SimulationClock::getFrameDeltaTime()
+{
+	return frameDeltaTime;
+}
+
+sf::Time SimulationClock::getElapsedTime()
+{
+	// one unit of delta time equals 10 ms
+	return sf::microseconds(static_cast<sf::Int64>(elapsedTime * 10000));
+}
+
+long long SimulationClock::getStepsCount()
+{
+	return stepsCount;
+}
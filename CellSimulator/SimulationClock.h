@@ -0,0 +1,60 @@
+#pragma once
+#include <SFML/System.hpp>
+
+// Fixed-step simulation clock.
+// Render frames have variable duration, simulation steps always have the same length (tick size).
+// Frame time is accumulated and consumed in whole ticks, so slow frames result in more steps - not in bigger ones.
+class SimulationClock final
+{
+public:
+	~SimulationClock();
+	static SimulationClock& getInstance();
+
+	// tick size uses the same units as frame delta time (0.0001 * microseconds)
+	// max steps per frame is multiplied by time scale when fast forwarding
+	void configure(float tickSize = 1.6667f, int maxStepsPerFrame = 5);
+
+	/// \param frameDeltaTime - duration of last render frame
+	/// \returns number of steps that have to be simulated in current frame
+	int advance(float frameDeltaTime);
+
+	// called by environment for each simulated step
+	void step(float deltaTime);
+
+	// drops accumulated frame time and the frame in progress (e.g. after loading environment)
+	void reset();
+
+	float getTickSize();
+	void setTickSize(float tickSize);
+
+	int getMaxStepsPerFrame();
+	void setMaxStepsPerFrame(int steps);
+
+	// > 1 - fast forward, < 1 - slow motion
+	float getTimeScale();
+	void setTimeScale(float scale);
+
+	// simulated time of steps returned by last advance call
+	float getFrameDeltaTime();
+
+	// simulated time since application start - advances only when simulation is active
+	sf::Time getElapsedTime();
+	long long getStepsCount();
+
+private:
+	SimulationClock();
+	SimulationClock(const SimulationClock&) = delete;
+	SimulationClock& operator=(const SimulationClock&) = delete;
+
+	float tickSize;
+	int maxStepsPerFrame;
+	float timeScale;
+
+	float accumulator;
+	// duration of frame that called reset() is not simulated
+	bool discardFrame;
+	float frameDeltaTime;
+
+	double elapsedTime;
+	long long stepsCount;
+};
@@ -2,21 +2,26 @@
 
 TextureProvider::TextureProvider()
 {
-	loadTexture("whiteNoise");
-	loadTexture("background");
-	loadTexture("background2");
-	loadTexture("greenLettuce");
-	loadTexture("pizza");
+	addTexture("whiteNoise");
+	addTexture("background");
+	addTexture("background2");
+	addTexture("greenLettuce");
+	addTexture("pizza");
 }
 
-void TextureProvider::loadTexture(const std::string &name)
+void TextureProvider::addTexture(const std::string & name)
+{
+	ids[name] = static_cast<TextureId>(names.size());
+	names.push_back(name);
+	textures.push_back(nullptr);
+}
+
+void TextureProvider::loadTexture(TextureId id)
 {
 	auto texture = std::make_shared<sf::Texture>();
-	texture->loadFromFile("./textures/" + name + ".png");
+	texture->loadFromFile("./textures/" + names[id] + ".png");
 	texture->setRepeated(true);
-	textures[name] = texture;
-
-	reverseTextureMap[texture.get()] = name;
+	textures[id] = texture;
 }
 
 TextureProvider::~TextureProvider()
@@ -31,10 +36,30 @@ TextureProvider & TextureProvider::getInstance()
 
 std::shared_ptr<sf::Texture> TextureProvider::getTexture(const std::string & name)
 {
-	return textures[name];
+	auto id = getTextureId(name);
+	if (id == noTexture) return nullptr;
+
+	getTexture(id);
+	return textures[id];
+}
+
+sf::Texture * TextureProvider::getTexture(TextureId id)
+{
+	if (id < 0 || id >= static_cast<TextureId>(textures.size())) return nullptr;
+
+	if (textures[id] == nullptr)
+		loadTexture(id);
+	return textures[id].get();
+}
+
+TextureProvider::TextureId TextureProvider::getTextureId(const std::string & name)
+{
+	auto it = ids.find(name);
+	return it != ids.end() ? it->second : noTexture;
 }
 
-std::string TextureProvider::getTextureName(const sf::Texture* ptr)
+std::string TextureProvider::getTextureName(TextureId id)
 {
-	return reverseTextureMap[ptr];
+	if (id < 0 || id >= static_cast<TextureId>(names.size())) return "";
+	return names[id];
 }
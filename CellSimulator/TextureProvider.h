@@ -1,25 +1,40 @@
 #pragma once
 #include <memory>
+#include <map>
+#include <vector>
 #include <SFML/Graphics.hpp>
+
+// Textures are loaded on first use - objects keep only texture ids, so simulation without drawing
+// (headless mode) never creates textures and needs no OpenGL context.
 class TextureProvider final
 {
 public:
+	using TextureId = int;
+	static constexpr TextureId noTexture = -1;
+
 	~TextureProvider();
 
 	static TextureProvider& getInstance();
 
 	std::shared_ptr<sf::Texture> getTexture(const std::string& name);
+	// nullptr for noTexture
+	sf::Texture* getTexture(TextureId id);
 
-	std::string getTextureName(const sf::Texture*  ptr);
+	// texture is not loaded - noTexture for unknown name
+	TextureId getTextureId(const std::string& name);
+	// empty for noTexture
+	std::string getTextureName(TextureId id);
 
 private:
 	TextureProvider();
 	TextureProvider(const TextureProvider&) = delete;
 	TextureProvider& operator=(const TextureProvider&) = delete;
 
-	void loadTexture(const std::string&);
+	void addTexture(const std::string& name);
+	void loadTexture(TextureId id);
 
-	std::map<std::string, std::shared_ptr<sf::Texture>> textures;
-	std::map<const sf::Texture*, std::string> reverseTextureMap;
+	std::vector<std::string> names;
+	// null until first use
+	std::vector<std::shared_ptr<sf::Texture>> textures;
+	std::map<std::string, TextureId> ids;
 };
-
@@ -0,0 +1,39 @@
+#pragma once
+#include <SFML/System/Vector2.hpp>
+
+// State of environment that does not change during one simulation step.
+// Environment fills it once at the beginning of step and passes it to every role-function,
+// so roles do not look up singletons or load atomic temperature / radiation for every cell.
+// It is read-only during step - roles can read it from worker threads.
+struct TickContext
+{
+	// duration of simulated step
+	float deltaTime = 0;
+	double temperature = 0;
+	double radiation = 0;
+	sf::Vector2f envSize;
+	// environment in Wrap boundary mode - toroidal world without borders
+	bool wrap = false;
+
+	// shortest vector from one position to another - in toroidal world it can cross borders
+	sf::Vector2f getDisplacement(const sf::Vector2f& from, const sf::Vector2f& to) const;
+
+	// displacement shortened by environment size on axes where it is longer than half of size
+	static sf::Vector2f wrapDisplacement(sf::Vector2f displacement, const sf::Vector2f& size);
+};
+
+inline sf::Vector2f TickContext::getDisplacement(const sf::Vector2f & from, const sf::Vector2f & to) const
+{
+	if (!wrap) return to - from;
+	return wrapDisplacement(to - from, envSize);
+}
+
+inline sf::Vector2f TickContext::wrapDisplacement(sf::Vector2f displacement, const sf::Vector2f & size)
+{
+	// the same operations for (a, b) and (b, a) - contacts stay symmetric
+	if (displacement.x > size.x / 2) displacement.x -= size.x;
+	else if (displacement.x < -size.x / 2) displacement.x += size.x;
+	if (displacement.y > size.y / 2) displacement.y -= size.y;
+	else if (displacement.y < -size.y / 2) displacement.y += size.y;
+	return displacement;
+}
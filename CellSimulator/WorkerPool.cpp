@@ -0,0 +1,115 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool() : job(nullptr), jobSize(0), chunkSize(1), nextIndex(0), busyWorkers(0), jobId(0), stopping(false)
+{
+	configure();
+}
+
+WorkerPool::~WorkerPool()
+{
+	stopWorkers();
+}
+
+WorkerPool & WorkerPool::getInstance()
+{
+	static WorkerPool instance;
+	return instance;
+}
+
+void WorkerPool::configure(unsigned int threadsCount)
+{
+	stopWorkers();
+
+	if (threadsCount == 0)
+		threadsCount = std::max(1u, std::thread::hardware_concurrency());
+
+	// calling thread is one of the workers
+	for (unsigned int i = 1; i < threadsCount; ++i)
+	{
+		workers.emplace_back(&WorkerPool::workerLoop, this, jobId);
+	}
+}
+
+unsigned int WorkerPool::getThreadsCount()
+{
+	return static_cast<unsigned int>(workers.size()) + 1;
+}
+
+void WorkerPool::parallelFor(size_t count, const RangeFunction & fn, size_t minChunk)
+{
+	if (count == 0)
+		return;
+
+	if (workers.empty() || count < 2 * minChunk)
+	{
+		fn(0, count);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		job = &fn;
+		jobSize = count;
+		// few chunks per thread - threads that finish early take over the rest
+		chunkSize = std::max(minChunk, count / (getThreadsCount() * 4));
+		nextIndex = 0;
+		busyWorkers = static_cast<unsigned int>(workers.size());
+		++jobId;
+	}
+	jobReady.notify_all();
+
+	processChunks();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	jobDone.wait(lock, [this] { return busyWorkers == 0; });
+	job = nullptr;
+}
+
+void WorkerPool::stopWorkers()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	jobReady.notify_all();
+
+	for (auto& w : workers)
+		w.join();
+	workers.clear();
+
+	stopping = false;
+}
+
+void WorkerPool::workerLoop(unsigned long long lastJobId)
+{
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			jobReady.wait(lock, [&] { return stopping || jobId != lastJobId; });
+			if (stopping)
+				return;
+			lastJobId = jobId;
+		}
+
+		processChunks();
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			--busyWorkers;
+		}
+		jobDone.notify_one();
+	}
+}
+
+void WorkerPool::processChunks()
+{
+	while (true)
+	{
+		size_t begin = nextIndex.fetch_add(chunkSize);
+		if (begin >= jobSize)
+			break;
+		(*job)(begin, std::min(begin + chunkSize, jobSize));
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+// Pool of worker threads used to split simulation loops between CPU cores.
+// Calling thread takes part in the work - parallelFor returns when whole range is processed.
+class WorkerPool final
+{
+public:
+	using RangeFunction = std::function<void(size_t begin, size_t end)>;
+
+	~WorkerPool();
+	static WorkerPool& getInstance();
+
+	// threadsCount = 0 - one thread per CPU core
+	void configure(unsigned int threadsCount = 0);
+	unsigned int getThreadsCount();
+
+	// calls fn for consecutive chunks of <0, count) range
+	// ranges smaller than 2 * minChunk are processed on calling thread
+	void parallelFor(size_t count, const RangeFunction& fn, size_t minChunk = 64);
+
+private:
+	WorkerPool();
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	void stopWorkers();
+	void workerLoop(unsigned long long lastJobId);
+	void processChunks();
+
+	std::vector<std::thread> workers;
+
+	std::mutex mutex;
+	std::condition_variable jobReady;
+	std::condition_variable jobDone;
+
+	const RangeFunction* job;
+	size_t jobSize;
+	size_t chunkSize;
+	std::atomic<size_t> nextIndex;
+	unsigned int busyWorkers;
+	unsigned long long jobId;
+	bool stopping;
+};